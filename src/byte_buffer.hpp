@@ -0,0 +1,68 @@
+#pragma once
+
+#include "types.hpp"
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Values are stored in host byte order, so files are read back on the same
+// kind of machine that wrote them.
+class ByteWriter {
+public:
+    explicit ByteWriter(std::vector<u8>& out) : m_out(out) {}
+
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto* bytes = reinterpret_cast<const u8*>(&value);
+        m_out.insert(m_out.end(), bytes, bytes + sizeof(T));
+    }
+
+    void put_string(std::string_view text) {
+        put(static_cast<u32>(text.size()));
+        m_out.insert(m_out.end(), text.begin(), text.end());
+    }
+
+private:
+    std::vector<u8>& m_out;
+};
+
+// Throws std::runtime_error when a read runs past the end of the data.
+class ByteReader {
+public:
+    explicit ByteReader(std::span<const u8> data) : m_data(data) {}
+
+    template <typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    std::string get_string() {
+        u32 size = get<u32>();
+        auto bytes = take(size);
+        return std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+
+    std::span<const u8> take(u64 size) {
+        if (size > remaining()) {
+            throw std::runtime_error("Unexpected end of data");
+        }
+        auto bytes = m_data.subspan(m_offset, size);
+        m_offset += size;
+        return bytes;
+    }
+
+    std::span<const u8> rest() { return take(remaining()); }
+    u64 remaining() const { return m_data.size() - m_offset; }
+
+private:
+    std::span<const u8> m_data;
+    u64 m_offset = 0;
+};
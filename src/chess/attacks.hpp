@@ -0,0 +1,92 @@
+#pragma once
+
+#include "chess/chess_types.hpp"
+
+namespace vgce::chess {
+
+namespace detail {
+
+using SquareTable = std::array<Bitboard, 64>;
+
+constexpr Bitboard offset_target(Square square, i32 file_step, i32 rank_step) {
+    i32 file = file_of(square) + file_step;
+    i32 rank = rank_of(square) + rank_step;
+    if (file < 0 || file > 7 || rank < 0 || rank > 7) {
+        return 0;
+    }
+    return bit(make_square(static_cast<u8>(file), static_cast<u8>(rank)));
+}
+
+template <std::size_t N>
+constexpr SquareTable leaper_table(const i32 (&steps)[N][2]) {
+    SquareTable table{};
+    for (Square square = 0; square < 64; ++square) {
+        for (const auto& step : steps) {
+            table[square] |= offset_target(square, step[0], step[1]);
+        }
+    }
+    return table;
+}
+
+constexpr i32 KNIGHT_STEPS[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2},
+                                    {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+constexpr i32 KING_STEPS[8][2] = {{0, 1}, {1, 1}, {1, 0}, {1, -1},
+                                  {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}};
+constexpr i32 WHITE_PAWN_STEPS[2][2] = {{-1, 1}, {1, 1}};
+constexpr i32 BLACK_PAWN_STEPS[2][2] = {{-1, -1}, {1, -1}};
+
+// Ray directions; the first four step towards higher square indices.
+constexpr i32 RAY_STEPS[8][2] = {{0, 1}, {1, 0}, {1, 1}, {-1, 1},
+                                 {0, -1}, {-1, 0}, {-1, -1}, {1, -1}};
+
+constexpr std::array<SquareTable, 8> RAYS = [] {
+    std::array<SquareTable, 8> rays{};
+    for (u8 direction = 0; direction < 8; ++direction) {
+        for (Square square = 0; square < 64; ++square) {
+            for (i32 distance = 1; distance < 8; ++distance) {
+                Bitboard target = offset_target(square, RAY_STEPS[direction][0] * distance,
+                                                RAY_STEPS[direction][1] * distance);
+                if (!target) {
+                    break;
+                }
+                rays[direction][square] |= target;
+            }
+        }
+    }
+    return rays;
+}();
+
+constexpr Bitboard ray_attacks(u8 direction, Square square, Bitboard occupied) {
+    Bitboard attacks = RAYS[direction][square];
+    Bitboard blockers = attacks & occupied;
+    if (blockers) {
+        Square first = direction < 4 ? lsb(blockers) : msb(blockers);
+        attacks ^= RAYS[direction][first];
+    }
+    return attacks;
+}
+
+} // namespace detail
+
+constexpr detail::SquareTable KNIGHT_ATTACKS = detail::leaper_table(detail::KNIGHT_STEPS);
+constexpr detail::SquareTable KING_ATTACKS = detail::leaper_table(detail::KING_STEPS);
+constexpr std::array<detail::SquareTable, 2> PAWN_ATTACKS = {
+    detail::leaper_table(detail::WHITE_PAWN_STEPS),
+    detail::leaper_table(detail::BLACK_PAWN_STEPS),
+};
+
+constexpr Bitboard rook_attacks(Square square, Bitboard occupied) {
+    return detail::ray_attacks(0, square, occupied) | detail::ray_attacks(1, square, occupied) |
+           detail::ray_attacks(4, square, occupied) | detail::ray_attacks(5, square, occupied);
+}
+
+constexpr Bitboard bishop_attacks(Square square, Bitboard occupied) {
+    return detail::ray_attacks(2, square, occupied) | detail::ray_attacks(3, square, occupied) |
+           detail::ray_attacks(6, square, occupied) | detail::ray_attacks(7, square, occupied);
+}
+
+static_assert(KNIGHT_ATTACKS[0] == (bit(10) | bit(17)));
+static_assert(KING_ATTACKS[63] == (bit(54) | bit(55) | bit(62)));
+static_assert(rook_attacks(0, bit(3) | bit(16)) == (bit(1) | bit(2) | bit(3) | bit(8) | bit(16)));
+
+} // namespace vgce::chess
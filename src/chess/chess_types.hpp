@@ -0,0 +1,111 @@
+#pragma once
+
+#include "types.hpp"
+#include <array>
+#include <bit>
+
+namespace vgce::chess {
+
+using Bitboard = u64;
+using Square = u8;
+
+constexpr Square NO_SQUARE = 64;
+
+enum class Color : u8 { White, Black };
+enum class PieceType : u8 { Pawn, Knight, Bishop, Rook, Queen, King, None };
+
+constexpr Color opposite(Color color) {
+    return color == Color::White ? Color::Black : Color::White;
+}
+
+constexpr u8 index(Color color) {
+    return static_cast<u8>(color);
+}
+
+constexpr u8 index(PieceType type) {
+    return static_cast<u8>(type);
+}
+
+struct Piece {
+    PieceType type = PieceType::None;
+    Color color = Color::White;
+
+    constexpr bool empty() const { return type == PieceType::None; }
+    // 0-11, used to index per-piece tables.
+    constexpr u8 index() const { return static_cast<u8>(chess::index(color) * 6 + chess::index(type)); }
+};
+
+constexpr u8 file_of(Square square) {
+    return square & 7;
+}
+
+constexpr u8 rank_of(Square square) {
+    return square >> 3;
+}
+
+constexpr Square make_square(u8 file, u8 rank) {
+    return static_cast<Square>(rank * 8 + file);
+}
+
+constexpr Bitboard bit(Square square) {
+    return 1ULL << square;
+}
+
+constexpr Square lsb(Bitboard bitboard) {
+    return static_cast<Square>(std::countr_zero(bitboard));
+}
+
+constexpr Square msb(Bitboard bitboard) {
+    return static_cast<Square>(63 - std::countl_zero(bitboard));
+}
+
+constexpr Square pop_lsb(Bitboard& bitboard) {
+    Square square = lsb(bitboard);
+    bitboard &= bitboard - 1;
+    return square;
+}
+
+// 16-bit move: from (6 bits), to (6 bits), promotion piece (2 bits), kind
+// (2 bits). Castling is encoded as the king's two-square move.
+class Move {
+public:
+    enum class Kind : u8 { Normal, Promotion, EnPassant, Castling };
+
+    constexpr Move() = default;
+    constexpr Move(Square from, Square to, Kind kind = Kind::Normal,
+                   PieceType promotion = PieceType::Knight)
+        : m_data(static_cast<u16>(from | (to << 6) |
+                                  ((index(promotion) - index(PieceType::Knight)) << 12) |
+                                  (static_cast<u16>(kind) << 14))) {}
+
+    constexpr Square from() const { return m_data & 63; }
+    constexpr Square to() const { return (m_data >> 6) & 63; }
+    constexpr Kind kind() const { return static_cast<Kind>(m_data >> 14); }
+    constexpr PieceType promotion() const {
+        return static_cast<PieceType>(((m_data >> 12) & 3) + index(PieceType::Knight));
+    }
+    constexpr bool is_null() const { return m_data == 0; }
+    // The packed form, for storing moves in files.
+    constexpr u16 raw() const { return m_data; }
+    static constexpr Move from_raw(u16 data) {
+        Move move;
+        move.m_data = data;
+        return move;
+    }
+
+    constexpr bool operator==(const Move&) const = default;
+
+private:
+    u16 m_data = 0;
+};
+
+struct MoveList {
+    std::array<Move, 256> moves;
+    u16 size = 0;
+
+    void push(Move move) { moves[size++] = move; }
+    const Move* begin() const { return moves.data(); }
+    const Move* end() const { return moves.data() + size; }
+};
+
+} // namespace vgce::chess
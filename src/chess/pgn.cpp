@@ -0,0 +1,144 @@
+#include "chess/pgn.hpp"
+#include <cctype>
+#include <stdexcept>
+
+namespace vgce::chess {
+
+namespace {
+
+bool is_result(std::string_view token) {
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+// Drops a leading move number such as "12." or "12...", which may be
+// written against the move.
+std::string_view strip_move_number(std::string_view token) {
+    u64 digits = 0;
+    while (digits < token.size() && std::isdigit(static_cast<unsigned char>(token[digits]))) {
+        digits++;
+    }
+    if (digits == 0 || digits == token.size() || token[digits] != '.') {
+        return token;
+    }
+    token.remove_prefix(digits);
+    while (!token.empty() && token.front() == '.') {
+        token.remove_prefix(1);
+    }
+    return token;
+}
+
+std::string parse_tag(std::string_view line, std::string& value) {
+    auto space = line.find(' ');
+    auto open = line.find('"');
+    auto close = line.rfind('"');
+    if (space == std::string_view::npos || open == std::string_view::npos || close <= open) {
+        throw std::runtime_error("Malformed PGN tag: " + std::string(line));
+    }
+    value.clear();
+    for (u64 i = open + 1; i < close; ++i) {
+        if (line[i] == '\\' && i + 1 < close) {
+            i++;
+        }
+        value += line[i];
+    }
+    return std::string(line.substr(1, space - 1));
+}
+
+} // namespace
+
+PgnGame parse_pgn(std::string_view text) {
+    PgnGame game;
+    u64 pos = 0;
+
+    // Tag pairs, one per line, until the movetext.
+    while (pos < text.size()) {
+        auto end = text.find('\n', pos);
+        auto line = text.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos);
+        while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) {
+            line.remove_suffix(1);
+        }
+        while (!line.empty() && std::isspace(static_cast<unsigned char>(line.front()))) {
+            line.remove_prefix(1);
+        }
+        if (!line.empty() && line.front() != '[') {
+            break;
+        }
+        if (!line.empty()) {
+            std::string value;
+            std::string name = parse_tag(line, value);
+            if (name == "FEN") {
+                game.start = value;
+            }
+            game.tags.emplace_back(std::move(name), std::move(value));
+        }
+        pos = end == std::string_view::npos ? text.size() : end + 1;
+    }
+
+    Position position = Position::from_string(game.start);
+    u32 variation_depth = 0;
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            pos++;
+            continue;
+        }
+        if (c == '{') {
+            auto close = text.find('}', pos);
+            pos = close == std::string_view::npos ? text.size() : close + 1;
+            continue;
+        }
+        if (c == ';') {
+            auto end = text.find('\n', pos);
+            pos = end == std::string_view::npos ? text.size() : end + 1;
+            continue;
+        }
+        if (c == '(') {
+            variation_depth++;
+            pos++;
+            continue;
+        }
+        if (c == ')') {
+            variation_depth -= variation_depth > 0 ? 1 : 0;
+            pos++;
+            continue;
+        }
+        // A second game's tags end the first.
+        if (c == '[' && variation_depth == 0) {
+            break;
+        }
+
+        u64 end = pos;
+        while (end < text.size() && !std::isspace(static_cast<unsigned char>(text[end])) &&
+               std::string_view("{}();").find(text[end]) == std::string_view::npos) {
+            end++;
+        }
+        if (end == pos) {
+            pos++;
+            continue;
+        }
+        auto token = text.substr(pos, end - pos);
+        pos = end;
+        if (variation_depth > 0 || token.front() == '$') {
+            continue;
+        }
+        if (is_result(token)) {
+            game.result = std::string(token);
+            break;
+        }
+        token = strip_move_number(token);
+        if (token.find_first_not_of("0123456789.") == std::string_view::npos) {
+            continue;
+        }
+
+        auto move = position.parse_san(token);
+        if (!move) {
+            throw std::runtime_error("Illegal PGN move '" + std::string(token) + "' at ply " +
+                                     std::to_string(game.moves.size() + 1));
+        }
+        position.make_move(*move);
+        game.moves.push_back(*move);
+    }
+    return game;
+}
+
+} // namespace vgce::chess
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "chess/position.hpp"
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace vgce::chess {
+
+struct PgnGame {
+    // In file order.
+    std::vector<std::pair<std::string, std::string>> tags;
+    // "startpos" or the FEN tag, as stored in AppConfig::positions.
+    std::string start = "startpos";
+    std::vector<Move> moves;
+    // The game result token, "*" if the movetext has none.
+    std::string result = "*";
+};
+
+// Reads the first game's tags and main line; comments, NAGs and variations
+// are dropped. Throws std::runtime_error on an illegal or unknown move.
+PgnGame parse_pgn(std::string_view text);
+
+} // namespace vgce::chess
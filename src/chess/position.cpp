@@ -0,0 +1,585 @@
+#include "chess/position.hpp"
+#include "chess/attacks.hpp"
+#include "chess/zobrist.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+
+namespace vgce::chess {
+
+namespace {
+
+constexpr u8 WHITE_SHORT = 1;
+constexpr u8 WHITE_LONG = 2;
+constexpr u8 BLACK_SHORT = 4;
+constexpr u8 BLACK_LONG = 8;
+
+constexpr Bitboard RANK_1 = 0xFFULL;
+constexpr Bitboard RANK_3 = RANK_1 << 16;
+constexpr Bitboard RANK_6 = RANK_1 << 40;
+constexpr Bitboard RANK_8 = RANK_1 << 56;
+
+// Castling rights kept when a move touches each square.
+constexpr std::array<u8, 64> CASTLING_MASK = [] {
+    std::array<u8, 64> mask{};
+    mask.fill(WHITE_SHORT | WHITE_LONG | BLACK_SHORT | BLACK_LONG);
+    mask[0] &= static_cast<u8>(~WHITE_LONG);
+    mask[4] &= static_cast<u8>(~(WHITE_SHORT | WHITE_LONG));
+    mask[7] &= static_cast<u8>(~WHITE_SHORT);
+    mask[56] &= static_cast<u8>(~BLACK_LONG);
+    mask[60] &= static_cast<u8>(~(BLACK_SHORT | BLACK_LONG));
+    mask[63] &= static_cast<u8>(~BLACK_SHORT);
+    return mask;
+}();
+
+constexpr std::string_view PIECE_CHARS = "PNBRQK";
+
+std::optional<Square> parse_square(std::string_view text) {
+    if (text.size() != 2 || text[0] < 'a' || text[0] > 'h' || text[1] < '1' || text[1] > '8') {
+        return std::nullopt;
+    }
+    return make_square(static_cast<u8>(text[0] - 'a'), static_cast<u8>(text[1] - '1'));
+}
+
+std::string square_name(Square square) {
+    return {static_cast<char>('a' + file_of(square)), static_cast<char>('1' + rank_of(square))};
+}
+
+std::optional<PieceType> parse_piece_char(char c) {
+    char upper = (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+    auto pos = PIECE_CHARS.find(upper);
+    if (pos == std::string_view::npos) {
+        return std::nullopt;
+    }
+    return static_cast<PieceType>(pos);
+}
+
+std::string_view next_field(std::string_view& text) {
+    while (!text.empty() && text.front() == ' ') {
+        text.remove_prefix(1);
+    }
+    auto end = text.find(' ');
+    auto field = text.substr(0, end);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end);
+    return field;
+}
+
+void add_pawn_moves(MoveList& moves, Square from, Square to) {
+    if (bit(to) & (RANK_1 | RANK_8)) {
+        moves.push(Move(from, to, Move::Kind::Promotion, PieceType::Queen));
+        moves.push(Move(from, to, Move::Kind::Promotion, PieceType::Rook));
+        moves.push(Move(from, to, Move::Kind::Promotion, PieceType::Bishop));
+        moves.push(Move(from, to, Move::Kind::Promotion, PieceType::Knight));
+    } else {
+        moves.push(Move(from, to));
+    }
+}
+
+void add_moves(MoveList& moves, Square from, Bitboard targets) {
+    while (targets) {
+        moves.push(Move(from, pop_lsb(targets)));
+    }
+}
+
+} // namespace
+
+Position Position::from_fen(std::string_view fen) {
+    auto fail = [&fen](const char* reason) {
+        return std::runtime_error("Invalid FEN '" + std::string(fen) + "': " + reason);
+    };
+
+    Position position;
+    std::string_view rest = fen;
+    std::string_view board = next_field(rest);
+    std::string_view side = next_field(rest);
+    std::string_view castling = next_field(rest);
+    std::string_view en_passant = next_field(rest);
+    std::string_view halfmove = next_field(rest);
+    std::string_view fullmove = next_field(rest);
+
+    i32 rank = 7;
+    i32 file = 0;
+    for (char c : board) {
+        if (c == '/') {
+            if (file != 8 || rank == 0) {
+                throw fail("bad rank layout");
+            }
+            --rank;
+            file = 0;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+        } else if (auto type = parse_piece_char(c)) {
+            if (file > 7) {
+                throw fail("bad rank layout");
+            }
+            Color color = (c >= 'a' && c <= 'z') ? Color::Black : Color::White;
+            position.put_piece(make_square(static_cast<u8>(file), static_cast<u8>(rank)),
+                               Piece{*type, color});
+            ++file;
+        } else {
+            throw fail("unexpected character in board");
+        }
+        if (file > 8) {
+            throw fail("bad rank layout");
+        }
+    }
+    if (rank != 0 || file != 8) {
+        throw fail("bad rank layout");
+    }
+    if (std::popcount(position.pieces(PieceType::King, Color::White)) != 1 ||
+        std::popcount(position.pieces(PieceType::King, Color::Black)) != 1) {
+        throw fail("each side needs exactly one king");
+    }
+
+    if (side == "b") {
+        position.m_side = Color::Black;
+        position.m_key ^= zobrist::KEYS.black_to_move;
+    } else if (side != "w") {
+        throw fail("side to move must be 'w' or 'b'");
+    }
+
+    if (castling != "-") {
+        for (char c : castling) {
+            switch (c) {
+            case 'K': position.m_castling |= WHITE_SHORT; break;
+            case 'Q': position.m_castling |= WHITE_LONG; break;
+            case 'k': position.m_castling |= BLACK_SHORT; break;
+            case 'q': position.m_castling |= BLACK_LONG; break;
+            default: throw fail("bad castling rights");
+            }
+        }
+    }
+    // Drop rights whose king or rook has left its home square.
+    auto has = [&position](Square square, PieceType type, Color color) {
+        Piece piece = position.m_board[square];
+        return piece.type == type && piece.color == color;
+    };
+    if (!has(4, PieceType::King, Color::White) || !has(7, PieceType::Rook, Color::White)) {
+        position.m_castling &= static_cast<u8>(~WHITE_SHORT);
+    }
+    if (!has(4, PieceType::King, Color::White) || !has(0, PieceType::Rook, Color::White)) {
+        position.m_castling &= static_cast<u8>(~WHITE_LONG);
+    }
+    if (!has(60, PieceType::King, Color::Black) || !has(63, PieceType::Rook, Color::Black)) {
+        position.m_castling &= static_cast<u8>(~BLACK_SHORT);
+    }
+    if (!has(60, PieceType::King, Color::Black) || !has(56, PieceType::Rook, Color::Black)) {
+        position.m_castling &= static_cast<u8>(~BLACK_LONG);
+    }
+    position.m_key ^= zobrist::KEYS.castling[position.m_castling];
+
+    if (!en_passant.empty() && en_passant != "-") {
+        auto square = parse_square(en_passant);
+        if (!square || (rank_of(*square) != 2 && rank_of(*square) != 5)) {
+            throw fail("bad en passant square");
+        }
+        position.set_en_passant(*square);
+    }
+
+    auto parse_counter = [&fail](std::string_view field, u16 fallback) {
+        if (field.empty()) {
+            return fallback;
+        }
+        u16 value = 0;
+        auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+        if (error != std::errc() || end != field.data() + field.size()) {
+            throw fail("bad move counter");
+        }
+        return value;
+    };
+    position.m_halfmove = parse_counter(halfmove, 0);
+    position.m_fullmove = std::max<u16>(parse_counter(fullmove, 1), 1);
+
+    Color them = opposite(position.m_side);
+    if (position.attackers_to(position.king_square(them), position.m_colors[0] | position.m_colors[1]) &
+        position.m_colors[index(position.m_side)]) {
+        throw fail("side not to move is in check");
+    }
+    return position;
+}
+
+Position Position::from_string(std::string_view position) {
+    return from_fen(position == "startpos" ? STARTPOS_FEN : position);
+}
+
+std::string Position::to_fen() const {
+    std::string fen;
+    for (i32 rank = 7; rank >= 0; --rank) {
+        i32 empty = 0;
+        for (u8 file = 0; file < 8; ++file) {
+            Piece piece = m_board[make_square(file, static_cast<u8>(rank))];
+            if (piece.empty()) {
+                ++empty;
+                continue;
+            }
+            if (empty > 0) {
+                fen += static_cast<char>('0' + empty);
+                empty = 0;
+            }
+            char c = PIECE_CHARS[index(piece.type)];
+            fen += piece.color == Color::Black ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+        if (empty > 0) {
+            fen += static_cast<char>('0' + empty);
+        }
+        if (rank > 0) {
+            fen += '/';
+        }
+    }
+    fen += m_side == Color::White ? " w " : " b ";
+    if (m_castling == 0) {
+        fen += '-';
+    } else {
+        if (m_castling & WHITE_SHORT) fen += 'K';
+        if (m_castling & WHITE_LONG) fen += 'Q';
+        if (m_castling & BLACK_SHORT) fen += 'k';
+        if (m_castling & BLACK_LONG) fen += 'q';
+    }
+    fen += ' ';
+    fen += m_en_passant == NO_SQUARE ? "-" : square_name(m_en_passant);
+    fen += " " + std::to_string(m_halfmove) + " " + std::to_string(m_fullmove);
+    return fen;
+}
+
+void Position::put_piece(Square square, Piece piece) {
+    m_board[square] = piece;
+    m_pieces[index(piece.type)] |= bit(square);
+    m_colors[index(piece.color)] |= bit(square);
+    m_key ^= zobrist::KEYS.pieces[piece.index()][square];
+}
+
+void Position::remove_piece(Square square) {
+    Piece piece = m_board[square];
+    m_board[square] = Piece{};
+    m_pieces[index(piece.type)] &= ~bit(square);
+    m_colors[index(piece.color)] &= ~bit(square);
+    m_key ^= zobrist::KEYS.pieces[piece.index()][square];
+}
+
+Bitboard Position::pieces(PieceType type, Color color) const {
+    return m_pieces[index(type)] & m_colors[index(color)];
+}
+
+Square Position::king_square(Color color) const {
+    return lsb(pieces(PieceType::King, color));
+}
+
+// Only recorded when a pawn can actually capture, so that transpositions
+// reach the same key.
+void Position::set_en_passant(Square square) {
+    Color capturer = m_side;
+    if (PAWN_ATTACKS[index(opposite(capturer))][square] & pieces(PieceType::Pawn, capturer)) {
+        m_en_passant = square;
+        m_key ^= zobrist::KEYS.en_passant_file[file_of(square)];
+    }
+}
+
+Bitboard Position::attackers_to(Square square, Bitboard occupied) const {
+    return (PAWN_ATTACKS[index(Color::White)][square] & pieces(PieceType::Pawn, Color::Black)) |
+           (PAWN_ATTACKS[index(Color::Black)][square] & pieces(PieceType::Pawn, Color::White)) |
+           (KNIGHT_ATTACKS[square] & m_pieces[index(PieceType::Knight)]) |
+           (KING_ATTACKS[square] & m_pieces[index(PieceType::King)]) |
+           (bishop_attacks(square, occupied) &
+            (m_pieces[index(PieceType::Bishop)] | m_pieces[index(PieceType::Queen)])) |
+           (rook_attacks(square, occupied) &
+            (m_pieces[index(PieceType::Rook)] | m_pieces[index(PieceType::Queen)]));
+}
+
+bool Position::is_in_check() const {
+    Bitboard occupied = m_colors[0] | m_colors[1];
+    return attackers_to(king_square(m_side), occupied) & m_colors[index(opposite(m_side))];
+}
+
+void Position::generate_pseudo_legal_moves(MoveList& moves) const {
+    Color us = m_side;
+    Color them = opposite(us);
+    Bitboard own = m_colors[index(us)];
+    Bitboard enemies = m_colors[index(them)];
+    Bitboard occupied = own | enemies;
+    Bitboard empty = ~occupied;
+
+    Bitboard pawns = pieces(PieceType::Pawn, us);
+    i32 forward = us == Color::White ? 8 : -8;
+    Bitboard single = us == Color::White ? (pawns << 8) & empty : (pawns >> 8) & empty;
+    Bitboard doubles = us == Color::White ? ((single & RANK_3) << 8) & empty
+                                          : ((single & RANK_6) >> 8) & empty;
+    while (single) {
+        Square to = pop_lsb(single);
+        add_pawn_moves(moves, static_cast<Square>(to - forward), to);
+    }
+    while (doubles) {
+        Square to = pop_lsb(doubles);
+        moves.push(Move(static_cast<Square>(to - 2 * forward), to));
+    }
+    for (Bitboard remaining = pawns; remaining;) {
+        Square from = pop_lsb(remaining);
+        Bitboard targets = PAWN_ATTACKS[index(us)][from] & enemies;
+        while (targets) {
+            add_pawn_moves(moves, from, pop_lsb(targets));
+        }
+    }
+    if (m_en_passant != NO_SQUARE) {
+        Bitboard capturers = PAWN_ATTACKS[index(them)][m_en_passant] & pawns;
+        while (capturers) {
+            moves.push(Move(pop_lsb(capturers), m_en_passant, Move::Kind::EnPassant));
+        }
+    }
+
+    for (Bitboard knights = pieces(PieceType::Knight, us); knights;) {
+        Square from = pop_lsb(knights);
+        add_moves(moves, from, KNIGHT_ATTACKS[from] & ~own);
+    }
+    Bitboard queens = pieces(PieceType::Queen, us);
+    for (Bitboard diagonal = pieces(PieceType::Bishop, us) | queens; diagonal;) {
+        Square from = pop_lsb(diagonal);
+        add_moves(moves, from, bishop_attacks(from, occupied) & ~own);
+    }
+    for (Bitboard straight = pieces(PieceType::Rook, us) | queens; straight;) {
+        Square from = pop_lsb(straight);
+        add_moves(moves, from, rook_attacks(from, occupied) & ~own);
+    }
+    Square king = king_square(us);
+    add_moves(moves, king, KING_ATTACKS[king] & ~own);
+
+    // The destination square is checked by is_legal() like any king move.
+    u8 short_right = us == Color::White ? WHITE_SHORT : BLACK_SHORT;
+    u8 long_right = us == Color::White ? WHITE_LONG : BLACK_LONG;
+    if ((m_castling & (short_right | long_right)) && !is_in_check()) {
+        Square base = us == Color::White ? 0 : 56;
+        auto is_attacked = [&](Square square) {
+            return (attackers_to(square, occupied) & enemies) != 0;
+        };
+        if ((m_castling & short_right) && !(occupied & (bit(base + 5) | bit(base + 6))) &&
+            !is_attacked(static_cast<Square>(base + 5))) {
+            moves.push(Move(king, static_cast<Square>(base + 6), Move::Kind::Castling));
+        }
+        if ((m_castling & long_right) &&
+            !(occupied & (bit(base + 1) | bit(base + 2) | bit(base + 3))) &&
+            !is_attacked(static_cast<Square>(base + 3))) {
+            moves.push(Move(king, static_cast<Square>(base + 2), Move::Kind::Castling));
+        }
+    }
+}
+
+// Checks the king is safe once the move is played, without making it.
+bool Position::is_legal(Move move) const {
+    Square from = move.from();
+    Square to = move.to();
+    Bitboard occupied = ((m_colors[0] | m_colors[1]) ^ bit(from)) | bit(to);
+    Bitboard enemies = m_colors[index(opposite(m_side))] & ~bit(to);
+    if (move.kind() == Move::Kind::EnPassant) {
+        Square captured = static_cast<Square>(to ^ 8);
+        occupied ^= bit(captured);
+        enemies ^= bit(captured);
+    }
+    Square king = m_board[from].type == PieceType::King ? to : king_square(m_side);
+    return !(attackers_to(king, occupied) & enemies);
+}
+
+void Position::generate_legal_moves(MoveList& moves) const {
+    MoveList pseudo;
+    generate_pseudo_legal_moves(pseudo);
+    for (Move move : pseudo) {
+        if (is_legal(move)) {
+            moves.push(move);
+        }
+    }
+}
+
+std::optional<Move> Position::parse_uci_move(std::string_view uci) const {
+    MoveList moves;
+    generate_legal_moves(moves);
+    for (Move move : moves) {
+        if (matches_uci(move, uci)) {
+            return move;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<Move> Position::parse_san(std::string_view san) const {
+    while (!san.empty() && std::string_view("+#!?").find(san.back()) != std::string_view::npos) {
+        san.remove_suffix(1);
+    }
+    std::string wanted(san);
+    if (wanted == "0-0" || wanted == "0-0-0") {
+        std::replace(wanted.begin(), wanted.end(), '0', 'O');
+    }
+    if (wanted.size() >= 3 && std::isupper(static_cast<unsigned char>(wanted.back())) &&
+        std::isdigit(static_cast<unsigned char>(wanted[wanted.size() - 2]))) {
+        wanted.insert(wanted.size() - 1, "=");
+    }
+
+    MoveList moves;
+    generate_legal_moves(moves);
+    for (Move move : moves) {
+        std::string candidate = to_san(move);
+        while (!candidate.empty() && (candidate.back() == '+' || candidate.back() == '#')) {
+            candidate.pop_back();
+        }
+        if (candidate == wanted) {
+            return move;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string Position::to_san(Move move) const {
+    std::string san;
+    Piece piece = m_board[move.from()];
+    bool is_capture = !m_board[move.to()].empty() || move.kind() == Move::Kind::EnPassant;
+
+    if (move.kind() == Move::Kind::Castling) {
+        san = file_of(move.to()) == 6 ? "O-O" : "O-O-O";
+    } else if (piece.type == PieceType::Pawn) {
+        if (is_capture) {
+            san += static_cast<char>('a' + file_of(move.from()));
+            san += 'x';
+        }
+        san += square_name(move.to());
+        if (move.kind() == Move::Kind::Promotion) {
+            san += '=';
+            san += PIECE_CHARS[index(move.promotion())];
+        }
+    } else {
+        san += PIECE_CHARS[index(piece.type)];
+        if (piece.type != PieceType::King) {
+            MoveList moves;
+            generate_legal_moves(moves);
+            bool is_ambiguous = false;
+            bool shares_file = false;
+            bool shares_rank = false;
+            for (Move other : moves) {
+                if (other.to() != move.to() || other.from() == move.from() ||
+                    m_board[other.from()].type != piece.type) {
+                    continue;
+                }
+                is_ambiguous = true;
+                shares_file |= file_of(other.from()) == file_of(move.from());
+                shares_rank |= rank_of(other.from()) == rank_of(move.from());
+            }
+            if (is_ambiguous) {
+                std::string from = square_name(move.from());
+                if (!shares_file) {
+                    san += from[0];
+                } else if (!shares_rank) {
+                    san += from[1];
+                } else {
+                    san += from;
+                }
+            }
+        }
+        if (is_capture) {
+            san += 'x';
+        }
+        san += square_name(move.to());
+    }
+
+    Position next = *this;
+    next.make_move(move);
+    if (next.is_in_check()) {
+        MoveList replies;
+        next.generate_legal_moves(replies);
+        san += replies.size == 0 ? '#' : '+';
+    }
+    return san;
+}
+
+void Position::make_move(Move move) {
+    Color us = m_side;
+    Square from = move.from();
+    Square to = move.to();
+    Piece moving = m_board[from];
+
+    if (m_en_passant != NO_SQUARE) {
+        m_key ^= zobrist::KEYS.en_passant_file[file_of(m_en_passant)];
+        m_en_passant = NO_SQUARE;
+    }
+    ++m_halfmove;
+
+    if (move.kind() == Move::Kind::Castling) {
+        bool is_short = file_of(to) == 6;
+        Square rook_from = static_cast<Square>(is_short ? to + 1 : to - 2);
+        Square rook_to = static_cast<Square>(is_short ? to - 1 : to + 1);
+        remove_piece(from);
+        remove_piece(rook_from);
+        put_piece(to, moving);
+        put_piece(rook_to, Piece{PieceType::Rook, us});
+    } else {
+        if (move.kind() == Move::Kind::EnPassant) {
+            remove_piece(static_cast<Square>(to ^ 8));
+            m_halfmove = 0;
+        } else if (!m_board[to].empty()) {
+            remove_piece(to);
+            m_halfmove = 0;
+        }
+        remove_piece(from);
+        if (move.kind() == Move::Kind::Promotion) {
+            put_piece(to, Piece{move.promotion(), us});
+        } else {
+            put_piece(to, moving);
+        }
+        if (moving.type == PieceType::Pawn) {
+            m_halfmove = 0;
+        }
+    }
+
+    m_key ^= zobrist::KEYS.castling[m_castling];
+    m_castling &= CASTLING_MASK[from] & CASTLING_MASK[to];
+    m_key ^= zobrist::KEYS.castling[m_castling];
+
+    if (us == Color::Black) {
+        ++m_fullmove;
+    }
+    m_side = opposite(us);
+    m_key ^= zobrist::KEYS.black_to_move;
+
+    if (moving.type == PieceType::Pawn && (from ^ to) == 16) {
+        set_en_passant(static_cast<Square>((from + to) / 2));
+    }
+}
+
+std::string move_to_uci(Move move) {
+    std::string uci = square_name(move.from()) + square_name(move.to());
+    if (move.kind() == Move::Kind::Promotion) {
+        uci += static_cast<char>(PIECE_CHARS[index(move.promotion())] - 'A' + 'a');
+    }
+    return uci;
+}
+
+bool matches_uci(Move move, std::string_view uci) {
+    if (uci.size() != 4 && uci.size() != 5) {
+        return false;
+    }
+    auto from = parse_square(uci.substr(0, 2));
+    auto to = parse_square(uci.substr(2, 2));
+    if (from != move.from() || to != move.to()) {
+        return false;
+    }
+    bool is_promotion = move.kind() == Move::Kind::Promotion;
+    if (is_promotion != (uci.size() == 5)) {
+        return false;
+    }
+    return !is_promotion || parse_piece_char(uci[4]) == move.promotion();
+}
+
+u64 perft(const Position& position, u16 depth) {
+    if (depth == 0) {
+        return 1;
+    }
+    MoveList moves;
+    position.generate_legal_moves(moves);
+    if (depth == 1) {
+        return moves.size;
+    }
+    u64 nodes = 0;
+    for (Move move : moves) {
+        Position next = position;
+        next.make_move(move);
+        nodes += perft(next, depth - 1);
+    }
+    return nodes;
+}
+
+} // namespace vgce::chess
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "chess/chess_types.hpp"
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace vgce::chess {
+
+// Board state with bitboards per piece type and colour plus a mailbox for
+// piece lookups. Positions are small and cheap to copy, so callers replaying
+// a line copy and call make_move() rather than unmaking.
+class Position {
+public:
+    static constexpr std::string_view STARTPOS_FEN =
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    // An empty board; use from_fen() or from_string() for a playable position.
+    Position() = default;
+
+    // Throws std::runtime_error on malformed input.
+    static Position from_fen(std::string_view fen);
+    // Accepts "startpos" or a FEN, as stored in AppConfig::positions.
+    static Position from_string(std::string_view position);
+
+    std::string to_fen() const;
+
+    void generate_legal_moves(MoveList& moves) const;
+    // Returns nullopt if the move is malformed or illegal here.
+    std::optional<Move> parse_uci_move(std::string_view uci) const;
+    // Accepts check marks, annotation suffixes, "0-0" castling and
+    // promotions without '='. Returns nullopt if no legal move matches.
+    std::optional<Move> parse_san(std::string_view san) const;
+    std::string to_san(Move move) const;
+    void make_move(Move move);
+
+    bool is_in_check() const;
+    Color side_to_move() const { return m_side; }
+    u16 fullmove_number() const { return m_fullmove; }
+    u64 key() const { return m_key; }
+    Piece piece_on(Square square) const { return m_board[square]; }
+
+private:
+    void put_piece(Square square, Piece piece);
+    void remove_piece(Square square);
+    void generate_pseudo_legal_moves(MoveList& moves) const;
+    bool is_legal(Move move) const;
+    Bitboard attackers_to(Square square, Bitboard occupied) const;
+    Bitboard pieces(PieceType type, Color color) const;
+    Square king_square(Color color) const;
+    void set_en_passant(Square square);
+
+    std::array<Bitboard, 6> m_pieces{};
+    std::array<Bitboard, 2> m_colors{};
+    std::array<Piece, 64> m_board{};
+    Color m_side = Color::White;
+    // Bits: white short, white long, black short, black long.
+    u8 m_castling = 0;
+    Square m_en_passant = NO_SQUARE;
+    u16 m_halfmove = 0;
+    u16 m_fullmove = 1;
+    u64 m_key = 0;
+};
+
+std::string move_to_uci(Move move);
+// Compares without generating moves, so only meaningful for a legal move.
+bool matches_uci(Move move, std::string_view uci);
+
+// Counts leaf nodes of the legal move tree, for validating move generation.
+u64 perft(const Position& position, u16 depth);
+
+} // namespace vgce::chess
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "chess/chess_types.hpp"
+
+namespace vgce::chess::zobrist {
+
+struct Keys {
+    std::array<std::array<u64, 64>, 12> pieces{};
+    std::array<u64, 16> castling{};
+    std::array<u64, 8> en_passant_file{};
+    u64 black_to_move = 0;
+};
+
+// Generated at compile time with splitmix64 so keys are stable across runs
+// and can be stored on disk.
+constexpr Keys KEYS = [] {
+    Keys keys;
+    u64 state = 0x9E3779B97F4A7C15ULL;
+    auto next = [&state] {
+        state += 0x9E3779B97F4A7C15ULL;
+        u64 z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    };
+    for (auto& squares : keys.pieces) {
+        for (auto& key : squares) {
+            key = next();
+        }
+    }
+    for (auto& key : keys.castling) {
+        key = next();
+    }
+    for (auto& key : keys.en_passant_file) {
+        key = next();
+    }
+    keys.black_to_move = next();
+    return keys;
+}();
+
+} // namespace vgce::chess::zobrist
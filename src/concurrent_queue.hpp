@@ -1,6 +1,8 @@
 #pragma once
 
 #include "types.hpp"
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <optional>
@@ -12,12 +14,14 @@ public:
     void push(const T& value) {
         std::lock_guard<std::mutex> lock(m_mutex);
         m_queue.push(value);
+        note_push();
         m_cv.notify_one();
     }
 
     void push(T&& value) {
         std::lock_guard<std::mutex> lock(m_mutex);
         m_queue.push(std::move(value));
+        note_push();
         m_cv.notify_one();
     }
 
@@ -28,6 +32,7 @@ public:
         }
         T value = std::move(m_queue.front());
         m_queue.pop();
+        m_depth.store(m_queue.size(), std::memory_order_relaxed);
         return value;
     }
 
@@ -36,6 +41,7 @@ public:
         if (m_cv.wait_for(lock, timeout, [this] { return !m_queue.empty(); })) {
             T value = std::move(m_queue.front());
             m_queue.pop();
+            m_depth.store(m_queue.size(), std::memory_order_relaxed);
             return value;
         }
         return std::nullopt;
@@ -55,10 +61,30 @@ public:
         std::lock_guard<std::mutex> lock(m_mutex);
         std::queue<T> empty;
         std::swap(m_queue, empty);
+        m_depth.store(0, std::memory_order_relaxed);
     }
 
+    // Lock-free statistics for monitoring.
+    u64 depth() const { return m_depth.load(std::memory_order_relaxed); }
+    u64 high_water() const { return m_high_water.load(std::memory_order_relaxed); }
+    u64 total_pushed() const { return m_total_pushed.load(std::memory_order_relaxed); }
+
 private:
+    // Called with m_mutex held, so plain stores are enough.
+    void note_push() {
+        u64 depth = m_queue.size();
+        m_depth.store(depth, std::memory_order_relaxed);
+        if (depth > m_high_water.load(std::memory_order_relaxed)) {
+            m_high_water.store(depth, std::memory_order_relaxed);
+        }
+        m_total_pushed.store(m_total_pushed.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_relaxed);
+    }
+
     std::queue<T> m_queue;
     mutable std::mutex m_mutex;
     std::condition_variable m_cv;
+    std::atomic<u64> m_depth{0};
+    std::atomic<u64> m_high_water{0};
+    std::atomic<u64> m_total_pushed{0};
 };
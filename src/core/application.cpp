@@ -1,7 +1,14 @@
 #include "core/application.hpp"
+#include "chess/position.hpp"
+#include "metrics/clock.hpp"
+#include "metrics/trace.hpp"
 #include "tui/renderer.hpp"
+#include "uci/event_loop.hpp"
 #include "uci/uci_parser.hpp"
+#include <algorithm>
+#include <cctype>
 #include <csignal>
+#include <cstdio>
 #include <iostream>
 #include <sstream>
 #include <thread>
@@ -11,11 +18,80 @@ namespace vgce::core {
 namespace {
 Application* g_app_instance = nullptr;
 
+constexpr auto REPLAY_TICK = std::chrono::milliseconds(10);
+// The per-ply budget for --pgn when neither --max-depth nor --stop-stable is given.
+constexpr u16 DEFAULT_PGN_DEPTH = 20;
+constexpr auto BESTMOVE_TIMEOUT = std::chrono::seconds(5);
+constexpr auto HEADLESS_INTERVAL = std::chrono::milliseconds(200);
+
 void signal_handler(i32) {
     if (g_app_instance) {
         g_app_instance->shutdown();
     }
 }
+
+// "d30" is a depth; "130" and "2:10" are times in seconds or minutes:seconds.
+std::optional<ReplayTarget> parse_replay_target(const std::string& text) {
+    if (text.size() > 1 && text[0] == 'd') {
+        i32 depth = std::atoi(text.c_str() + 1);
+        if (depth <= 0) {
+            return std::nullopt;
+        }
+        return ReplayTarget{ReplayTarget::Kind::Depth, depth};
+    }
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0]))) {
+        return std::nullopt;
+    }
+    i64 seconds = std::atoll(text.c_str());
+    if (auto colon = text.find(':'); colon != std::string::npos) {
+        seconds = seconds * 60 + std::atoll(text.c_str() + colon + 1);
+    }
+    return ReplayTarget{ReplayTarget::Kind::Time, seconds * 1'000'000'000};
+}
+
+// "position startpos|fen <fen> [moves ...]" as a GUI sends it; nullopt if
+// the moves cannot be followed.
+std::optional<chess::Position> parse_position_command(std::string_view command) {
+    constexpr std::string_view MOVES = " moves";
+    auto moves_at = command.find(MOVES);
+    auto setup = command.substr(0, moves_at);
+    setup.remove_prefix(std::min(setup.find(' '), setup.size()));
+    setup.remove_prefix(std::min(setup.find_first_not_of(' '), setup.size()));
+    std::string fen;
+    if (setup == "startpos") {
+        fen = "startpos";
+    } else if (setup.starts_with("fen ")) {
+        fen = setup.substr(4);
+    } else {
+        return std::nullopt;
+    }
+    try {
+        auto position = chess::Position::from_string(fen);
+        if (moves_at != std::string_view::npos) {
+            std::istringstream moves{std::string(command.substr(moves_at + MOVES.size()))};
+            std::string uci;
+            while (moves >> uci) {
+                auto move = position.parse_uci_move(uci);
+                if (!move) {
+                    return std::nullopt;
+                }
+                position.make_move(*move);
+            }
+        }
+        return position;
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+std::string format_headless_score(const uci::Score& score) {
+    if (score.type == uci::Score::Type::Mate) {
+        return "#" + std::to_string(score.value);
+    }
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "%+.2f", score.value / 100.0);
+    return buffer;
+}
 } // namespace
 
 Application::Application() {
@@ -36,10 +112,21 @@ void Application::setup_signal_handlers() {
 
 void Application::shutdown() {
     m_is_shutting_down.store(true);
-    m_screen.PostEvent(ftxui::Event::Custom);
+    request_frame();
+}
+
+void Application::request_frame() {
+    if (!m_headless) {
+        m_screen.PostEvent(ftxui::Event::Custom);
+    }
 }
 
 void Application::toggle_pause() {
+    // Behind a GUI, or on another vgce's engine, the search is not ours to
+    // start and stop.
+    if (m_config.proxy || m_viewer) {
+        return;
+    }
     bool was_paused = m_is_paused.load();
     m_is_paused.store(!was_paused);
     
@@ -48,17 +135,48 @@ void Application::toggle_pause() {
     } else {
         stop_search();
     }
-    m_screen.PostEvent(ftxui::Event::Custom);
+    request_frame();
 }
 
 void Application::clear_tree() {
+    if (m_refiner) {
+        m_refiner->cancel_all();
+    }
     m_search_tree.clear();
-    m_global_stats.nodes.store(0);
-    m_global_stats.nps.store(0);
-    m_global_stats.hashfull.store(0);
-    m_global_stats.tbhits.store(0);
-    m_global_stats.time_ms.store(0);
-    m_screen.PostEvent(ftxui::Event::Custom);
+    for (auto& depth : m_cached_line_depths) {
+        depth.store(0);
+    }
+    for (auto& session : m_comparisons) {
+        session->clear();
+    }
+    reset_search_stats();
+    publish_root_change();
+    request_frame();
+}
+
+void Application::publish_info(const uci::InfoData& info) {
+    if (m_recorder && !info.pv.empty()) {
+        m_recorder->record_info(info);
+        if (m_recorder->checkpoint_due()) {
+            m_recorder->record_checkpoint(m_search_tree, false);
+        }
+    }
+    if (m_server) {
+        m_server->publish_info(info);
+    }
+}
+
+void Application::publish_root_change() {
+    if (m_recorder) {
+        m_recorder->record_checkpoint(m_search_tree, true);
+    }
+    if (m_server) {
+        m_server->publish_root_change();
+    }
+}
+
+void Application::reset_search_stats() {
+    clear_search_stats(m_global_stats);
 }
 
 void Application::export_tree() {
@@ -70,7 +188,7 @@ void Application::export_tree() {
         export_file << "VGCE Tree Export\n";
         export_file << "================\n\n";
         export_file << "Engine: " << m_global_stats.engine_name << "\n";
-        export_file << "Position: " << m_config.position_fen << "\n";
+        export_file << "Position: " << current_position() << "\n";
         export_file << "Nodes: " << m_global_stats.nodes.load() << "\n";
         export_file << "Time: " << m_global_stats.time_ms.load() << "ms\n\n";
         export_file << m_search_tree.export_to_string();
@@ -78,10 +196,137 @@ void Application::export_tree() {
     }
 }
 
+void Application::dump_trace() {
+    metrics::trace::dump("vgce_trace_" +
+        std::to_string(std::chrono::system_clock::now().time_since_epoch().count()) + ".json");
+}
+
+void Application::next_position() {
+    m_advance_requested.store(true);
+}
+
 bool Application::is_paused() const {
     return m_is_paused.load();
 }
 
+const std::string& Application::current_position() const {
+    return m_config.positions[m_position_index.load()];
+}
+
+u16 Application::converged_depth() const {
+    return m_converged_depth.load();
+}
+
+u64 Application::position_index() const {
+    return m_position_index.load();
+}
+
+u64 Application::position_count() const {
+    return m_config.positions.size();
+}
+
+metrics::PipelineLatency& Application::latency() {
+    return m_latency;
+}
+
+// Called every frame, so like queue_stats() it reads the current engine's
+// counters through their own snapshot rather than waiting on m_engine_mutex.
+process::PipeStats Application::pipe_stats() {
+    auto pipe = m_pipe_counters.load();
+    return pipe ? pipe->snapshot() : process::PipeStats{};
+}
+
+// Called every frame and scrape, so it reads the current engine's queue
+// through its own snapshot rather than waiting on m_engine_mutex.
+metrics::QueueStats Application::queue_stats() {
+    auto queue = m_output_queue.load();
+    if (!queue) {
+        return {};
+    }
+    return {queue->depth(), queue->high_water(), queue->total_pushed()};
+}
+
+metrics::PipelineCounters& Application::counters() {
+    return m_counters;
+}
+
+const std::vector<std::unique_ptr<EngineSession>>& Application::comparisons() const {
+    return m_comparisons;
+}
+
+bool Application::refine_node(std::vector<std::string> path) {
+    return m_refiner && !path.empty() && m_refiner->refine(std::move(path));
+}
+
+u16 Application::refinements_running() const {
+    return m_refiner ? m_refiner->active_count() : 0;
+}
+
+bool Application::is_replaying() const {
+    return m_replay != nullptr;
+}
+
+void Application::seek_replay(const ReplayTarget& target) {
+    std::lock_guard<std::mutex> lock(m_seek_mutex);
+    m_seek_request = target;
+}
+
+u64 Application::replay_cursor_ns() const {
+    return m_replay_cursor_ns.load();
+}
+
+u64 Application::replay_duration_ns() const {
+    return m_replay ? m_replay->duration_ns() : 0;
+}
+
+u16 Application::replay_depth() const {
+    return m_replay_depth.load();
+}
+
+bool Application::load_game(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    try {
+        m_game = std::make_unique<GameAnalysis>(chess::parse_pgn(text.str()));
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: Skipping game: " << e.what() << "\n";
+        return false;
+    }
+    m_config.positions = m_game->positions();
+    if (m_config.pgn_output.empty()) {
+        m_config.pgn_output = std::filesystem::path(path).replace_extension(".annotated.pgn");
+    }
+    return true;
+}
+
+bool Application::load_positions(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        try {
+            chess::Position::from_string(line);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: Skipping position: " << e.what() << "\n";
+            continue;
+        }
+        m_config.positions.push_back(line);
+    }
+    return true;
+}
+
 void Application::print_usage(const char* program_name) {
     std::cerr << "Usage: " << program_name << " <engine_executable> [options]\n"
               << "Try '" << program_name << " -h' for more information.\n";
@@ -93,6 +338,8 @@ VGCE - Visual Game-tree Chess Engine Explorer v0.1.1
 
 USAGE:
     vgce <engine_executable> [OPTIONS]
+    vgce --replay <session_file> [OPTIONS]
+    vgce --connect <socket> [OPTIONS]
 
 ARGUMENTS:
     <engine_executable>    Path to UCI chess engine executable
@@ -118,17 +365,108 @@ OPTIONS:
     
     --no-log                       Disable engine output logging
     
+    --merge-transpositions         Share one node between lines reaching the same
+                                   position at the same ply
+    
+    --tree-memory <MB>             Evict branches off the current lines, least
+                                   recently updated first, to stay within MB
+                                   (per engine with --compare)
+    
     --uci-option <name>=<value>    Send custom UCI option to engine
                                    Can be specified multiple times
                                    Example: --uci-option Hash=2048
 
+    --stop-stable <depths>         Stop the search once the best move holds and the
+                                   score stays within --stop-window for this many
+                                   consecutive depths
+    --stop-window <cp>             Score window for --stop-stable (default: 10)
+    --stop-wdl <permille>          Also count depths whose W/D/L stay within this
+                                   window as stable
+    --stop-min-depth <depth>       Never stop before this depth
+
+    --positions <file>             Analyse positions from a file, one per line
+                                   ('startpos' or FEN). With --max-depth or
+                                   --stop-stable the next position starts when a
+                                   search finishes
+    --pgn <file>                   Analyse every position of the first game in a
+                                   PGN on one engine, keeping its hash between
+                                   plies, and write the game annotated with ?!, ?
+                                   and ?? (depth 20 per ply unless --max-depth or
+                                   --stop-stable is given)
+    --pgn-out <file>               Annotated PGN path (default: <game>.annotated.pgn)
+    --engine-pool <n>              Keep n extra engines launched, handshaken and
+                                   configured so the next position starts warm
+
+    --pipe-size <KB>               Engine output pipe size (default: 1024)
+                                   Capped by /proc/sys/fs/pipe-max-size
+
+    --stats-interval <ms>          Engine/vgce CPU and memory sampling interval
+                                   (default: 1000, 0 disables)
+    --metrics-port <port>          Serve Prometheus metrics on
+                                   http://127.0.0.1:<port>/metrics
+    --metrics-file <file>          Write Prometheus metrics to a file for the
+                                   node_exporter textfile collector
+    --metrics-interval <ms>        How often that file is rewritten (default: 5000)
+
+    --latency-budget <ms>          Flag engine-to-screen p99 latency above this
+                                   budget in the latency overlay
+
+    --engine-cpus <list>           Pin the engine process to CPUs (e.g. 0-7,16-23)
+    --engine-numa <node|auto>      Bind engine CPUs and memory to a NUMA node
+                                   'auto' spreads engines across nodes
+    --engine-nice <n>              Nice value for the engine process
+    --engine-sched <policy>        Scheduling policy: other, batch, idle, fifo, rr
+
+    --record <file>                Record the session to a binary file for --replay
+    --replay <file>                Replay a recorded session instead of running
+                                   an engine; must be the first argument
+    --replay-at <d30|2:10|130>     Start the replay at a depth or a time
+
+    --serve <socket>               Share this engine's analysis with other vgce
+                                   viewers over a local socket
+    --connect <socket>             Follow a --serve session instead of running an
+                                   engine; must be the first argument
+    --shm <name>                   Publish stats and top lines in shared memory
+                                   for other processes (see vgce_snapshot)
+
+    --compare <engine>             Run another engine on the same positions and
+                                   show its tree beside the main one; repeatable
+
+    --refine-engines <n>           Engines for searching a picked tree node with
+                                   'r' (default: 1, 0 disables)
+    --refine-depth <depth>         Depth of those searches (default: 24)
+
+    --cache <file>                 Keep the best lines per position in an on-disk
+                                   cache; cached positions open with their lines
+                                   and, with --max-depth, batches skip positions
+                                   already cached that deep
+
+    --proxy                        Act as the engine for a GUI or tournament manager:
+                                   its commands on stdin go to the engine and the
+                                   engine's output comes back on stdout unchanged,
+                                   while vgce follows the search
+    --tty <device>                 With --proxy, draw the viewer on this terminal
+                                   (e.g. /dev/pts/3); without it a line per depth
+                                   goes to stderr
+
+    --ui-cpus <list>               Pin vgce's reader, processing and render threads
+    --ui-nice <n>                  Nice value for vgce's own threads
+
 INTERACTIVE CONTROLS:
-    Arrow Up/Down       Scroll through the search tree
+    Arrow Up/Down       Move the cursor through the search tree
+    r                   Search the node under the cursor on a refinement
+                        engine and graft its lines below it
     Page Up/Down        Scroll faster (5 lines)
     Home/End            Jump to top/bottom
     Space               Pause/Resume search
     c                   Clear tree and restart
     e                   Export tree to text file
+    l                   Toggle pipeline latency overlay
+    p                   Toggle viewer performance overlay
+    t                   Dump pipeline trace (builds with VGCE_ENABLE_TRACING)
+    n                   Next position from --positions
+    [ ]                 Replay: previous/next depth
+    , .                 Replay: back/forward 10 seconds
     q, Ctrl+C           Quit application
 
 EXAMPLES:
@@ -147,9 +485,13 @@ EXAMPLES:
     # Start paused for manual control
     ./vgce stockfish --pause --pv-depth 25
 
+    # Watch a GUI's engine on another terminal (set the GUI's engine command to this)
+    ./vgce stockfish --proxy --tty /dev/pts/3
+
 COLOR GUIDE:
     Green               PV (Principal Variation) moves
     Cyan                Alternative MultiPV lines
+    Blue ⟳              Lines grafted by a refinement search
     Red/Green           Evaluation scores (bad/good)
     Yellow              Transposition table hits, WDL stats
     Gray                Metadata and structural elements
@@ -181,9 +523,19 @@ void Application::parse_arguments(i32 argc, char* argv[]) {
         return;
     }
 
-    m_config.engine_path = argv[1];
+    i32 first_option = 2;
+    if (std::string(argv[1]) == "--replay" || std::string(argv[1]) == "--connect") {
+        if (argc < 3) {
+            print_usage(argv[0]);
+            throw std::runtime_error(std::string(argv[1]) == "--replay" ? "Missing session file" : "Missing socket path");
+        }
+        (std::string(argv[1]) == "--replay" ? m_config.replay_path : m_config.connect_path) = argv[2];
+        first_option = 3;
+    } else {
+        m_config.engine_path = argv[1];
+    }
 
-    for (i32 i = 2; i < argc; ++i) {
+    for (i32 i = first_option; i < argc; ++i) {
         std::string arg = argv[i];
         
         if (arg == "-h" || arg == "--help") {
@@ -217,19 +569,200 @@ void Application::parse_arguments(i32 argc, char* argv[]) {
             }
         } else if (arg == "--pause") {
             m_config.pause_on_start = true;
+        } else if (arg == "--tree-memory" && i + 1 < argc) {
+            i32 megabytes = std::atoi(argv[++i]);
+            if (megabytes > 0) {
+                m_config.tree_memory_mb = static_cast<u32>(megabytes);
+            } else {
+                std::cerr << "Warning: Invalid tree memory budget, using no limit\n";
+            }
+        } else if (arg == "--stop-stable" && i + 1 < argc) {
+            i32 depths = std::atoi(argv[++i]);
+            if (depths > 0 && depths <= 100) {
+                m_config.stop_rule.stable_depths = static_cast<u16>(depths);
+            } else {
+                std::cerr << "Warning: Invalid stable depth count, auto-stop disabled\n";
+            }
+        } else if (arg == "--stop-window" && i + 1 < argc) {
+            i32 window = std::atoi(argv[++i]);
+            if (window >= 0) {
+                m_config.stop_rule.score_window_cp = window;
+            } else {
+                std::cerr << "Warning: Invalid stop score window, using default (10)\n";
+            }
+        } else if (arg == "--stop-wdl" && i + 1 < argc) {
+            i32 window = std::atoi(argv[++i]);
+            if (window > 0 && window <= 1000) {
+                m_config.stop_rule.wdl_window = static_cast<u16>(window);
+            } else {
+                std::cerr << "Warning: Invalid stop W/D/L window, ignoring W/D/L\n";
+            }
+        } else if (arg == "--stop-min-depth" && i + 1 < argc) {
+            i32 depth = std::atoi(argv[++i]);
+            if (depth > 0 && depth <= 255) {
+                m_config.stop_rule.min_depth = static_cast<u16>(depth);
+            } else {
+                std::cerr << "Warning: Invalid stop minimum depth, using no minimum\n";
+            }
+        } else if (arg == "--record" && i + 1 < argc) {
+            m_config.record_path = argv[++i];
+        } else if (arg == "--serve" && i + 1 < argc) {
+            m_config.serve_path = argv[++i];
+        } else if (arg == "--shm" && i + 1 < argc) {
+            m_config.shm_name = argv[++i];
+        } else if (arg == "--compare" && i + 1 < argc) {
+            m_config.compare_engines.push_back(argv[++i]);
+        } else if (arg == "--refine-engines" && i + 1 < argc) {
+            i32 count = std::atoi(argv[++i]);
+            if (count >= 0 && count <= 16) {
+                m_config.refine_engines = static_cast<u16>(count);
+            } else {
+                std::cerr << "Warning: Invalid refinement engine count, using default (1)\n";
+            }
+        } else if (arg == "--refine-depth" && i + 1 < argc) {
+            i32 depth = std::atoi(argv[++i]);
+            if (depth > 0 && depth <= 255) {
+                m_config.refine_depth = static_cast<u16>(depth);
+            } else {
+                std::cerr << "Warning: Invalid refinement depth, using default (24)\n";
+            }
+        } else if (arg == "--proxy") {
+            m_config.proxy = true;
+        } else if (arg == "--tty" && i + 1 < argc) {
+            m_config.proxy_tty = argv[++i];
+        } else if (arg == "--cache" && i + 1 < argc) {
+            m_config.cache_path = argv[++i];
+        } else if (arg == "--replay-at" && i + 1 < argc) {
+            m_config.replay_start = parse_replay_target(argv[++i]);
+            if (!m_config.replay_start) {
+                std::cerr << "Warning: Invalid replay start '" << argv[i] << "', starting at the beginning\n";
+            }
+        } else if (arg == "--merge-transpositions") {
+            m_config.merge_transpositions = true;
         } else if (arg == "--no-log") {
             m_config.enable_logging = false;
         } else if (arg == "--uci-option" && i + 1 < argc) {
             m_config.custom_uci_options.push_back(argv[++i]);
+        } else if (arg == "--positions" && i + 1 < argc) {
+            if (!load_positions(argv[++i])) {
+                std::cerr << "Warning: Could not read positions file '" << argv[i] << "'\n";
+            }
+        } else if (arg == "--pgn" && i + 1 < argc) {
+            if (!load_game(argv[++i])) {
+                std::cerr << "Warning: Could not read game from '" << argv[i] << "'\n";
+            }
+        } else if (arg == "--pgn-out" && i + 1 < argc) {
+            m_config.pgn_output = argv[++i];
+        } else if (arg == "--engine-pool" && i + 1 < argc) {
+            i32 spares = std::atoi(argv[++i]);
+            if (spares >= 0 && spares <= 64) {
+                m_config.engine_spares = static_cast<u16>(spares);
+            } else {
+                std::cerr << "Warning: Invalid engine pool size, using default (0)\n";
+            }
+        } else if (arg == "--pipe-size" && i + 1 < argc) {
+            i32 size_kb = std::atoi(argv[++i]);
+            if (size_kb >= 64) {
+                m_config.pipe_size = static_cast<u64>(size_kb) * 1024;
+            } else {
+                std::cerr << "Warning: Invalid pipe size, using default (1024 KB)\n";
+            }
+        } else if (arg == "--stats-interval" && i + 1 < argc) {
+            i32 interval = std::atoi(argv[++i]);
+            if (interval >= 0) {
+                m_config.stats_interval_ms = static_cast<u32>(interval);
+            } else {
+                std::cerr << "Warning: Invalid stats interval, using default (1000)\n";
+            }
+        } else if (arg == "--metrics-port" && i + 1 < argc) {
+            i32 port = std::atoi(argv[++i]);
+            if (port > 0 && port <= 65535) {
+                m_config.metrics_port = static_cast<u16>(port);
+            } else {
+                std::cerr << "Warning: Invalid metrics port, metrics not served\n";
+            }
+        } else if (arg == "--metrics-file" && i + 1 < argc) {
+            m_config.metrics_file = argv[++i];
+        } else if (arg == "--metrics-interval" && i + 1 < argc) {
+            i32 interval = std::atoi(argv[++i]);
+            if (interval > 0) {
+                m_config.metrics_interval_ms = static_cast<u32>(interval);
+            }
+        } else if (arg == "--latency-budget" && i + 1 < argc) {
+            i32 budget = std::atoi(argv[++i]);
+            if (budget > 0) {
+                m_config.latency_budget_ms = static_cast<u32>(budget);
+            }
+        } else if (arg == "--engine-cpus" && i + 1 < argc) {
+            if (auto cpus = process::parse_cpu_list(argv[++i])) {
+                m_config.engine_placement.cpus = *cpus;
+            } else {
+                std::cerr << "Warning: Invalid CPU list '" << argv[i] << "', ignoring\n";
+            }
+        } else if (arg == "--engine-numa" && i + 1 < argc) {
+            std::string node = argv[++i];
+            if (node == "auto") {
+                m_config.engine_placement.auto_numa = true;
+            } else if (!node.empty() && std::isdigit(static_cast<unsigned char>(node[0]))) {
+                m_config.engine_placement.numa_node = static_cast<u32>(std::atoi(node.c_str()));
+            } else {
+                std::cerr << "Warning: Invalid NUMA node '" << node << "', ignoring\n";
+            }
+        } else if (arg == "--engine-nice" && i + 1 < argc) {
+            m_config.engine_placement.nice = std::atoi(argv[++i]);
+        } else if (arg == "--engine-sched" && i + 1 < argc) {
+            if (auto policy = process::parse_sched_policy(argv[++i])) {
+                m_config.engine_placement.policy = *policy;
+            } else {
+                std::cerr << "Warning: Unknown scheduling policy '" << argv[i] << "', ignoring\n";
+            }
+        } else if (arg == "--ui-cpus" && i + 1 < argc) {
+            if (auto cpus = process::parse_cpu_list(argv[++i])) {
+                m_config.ui_placement.cpus = *cpus;
+            } else {
+                std::cerr << "Warning: Invalid CPU list '" << argv[i] << "', ignoring\n";
+            }
+        } else if (arg == "--ui-nice" && i + 1 < argc) {
+            m_config.ui_placement.nice = std::atoi(argv[++i]);
         } else {
             std::cerr << "Warning: Unknown argument '" << arg << "'\n";
         }
     }
+
+    if (m_config.proxy && (m_game || !m_config.positions.empty() || !m_config.compare_engines.empty() ||
+                           !m_config.cache_path.empty() || m_config.stop_rule.enabled() ||
+                           m_config.max_depth > 0 || m_config.pause_on_start)) {
+        std::cerr << "Warning: The GUI drives the search with --proxy; ignoring positions, games, "
+                     "depth and stop limits, --pause, --compare and --cache\n";
+        m_game.reset();
+        m_config.positions.clear();
+        m_config.compare_engines.clear();
+        m_config.cache_path.clear();
+        m_config.stop_rule = {};
+        m_config.max_depth = 0;
+        m_config.pause_on_start = false;
+    }
+    if (!m_config.proxy && !m_config.proxy_tty.empty()) {
+        std::cerr << "Warning: --tty only applies with --proxy, ignoring\n";
+    }
+    if (m_game && m_config.max_depth == 0 && !m_config.stop_rule.enabled()) {
+        m_config.max_depth = DEFAULT_PGN_DEPTH;
+    }
+    if (m_config.positions.empty()) {
+        try {
+            chess::Position::from_string(m_config.position_fen);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            throw;
+        }
+        m_config.positions.push_back(m_config.position_fen);
+    }
 }
 
-void Application::send_uci_options() {
+std::vector<std::string> Application::build_setup_commands() const {
+    std::vector<std::string> commands;
     if (m_config.multi_pv > 1) {
-        m_uci_client->send_command("setoption name MultiPV value " + std::to_string(m_config.multi_pv));
+        commands.push_back("setoption name MultiPV value " + std::to_string(m_config.multi_pv));
     }
     
     for (const auto& option : m_config.custom_uci_options) {
@@ -237,34 +770,177 @@ void Application::send_uci_options() {
         if (pos != std::string::npos) {
             std::string name = option.substr(0, pos);
             std::string value = option.substr(pos + 1);
-            m_uci_client->send_command("setoption name " + name + " value " + value);
+            commands.push_back("setoption name " + name + " value " + value);
         }
     }
+    return commands;
+}
+
+void Application::send_command(std::string_view command) {
+    std::lock_guard<std::mutex> lock(m_engine_mutex);
+    if (m_uci_client) {
+        m_uci_client->send_command(command);
+    }
 }
 
 void Application::send_position() {
-    if (m_config.position_fen == "startpos") {
-        m_uci_client->send_command("position startpos");
+    const std::string& position = current_position();
+    auto root = chess::Position::from_string(position);
+    m_root_key = root.key();
+    m_search_tree.set_root_position(root);
+    seed_from_cache();
+    if (m_refiner) {
+        m_refiner->cancel_all();
+    }
+    for (auto& session : m_comparisons) {
+        session->set_position(position);
+    }
+    publish_root_change();
+    if (m_game) {
+        send_command(m_game->position_command(m_position_index.load()));
+    } else if (position == "startpos") {
+        send_command("position startpos");
     } else {
-        m_uci_client->send_command("position fen " + m_config.position_fen);
+        send_command("position fen " + position);
+    }
+}
+
+void Application::record_game_ply() {
+    auto line = m_search_tree.get_main_line();
+    if (!line || !line->stats.has_score) {
+        return;
+    }
+    m_game->record(m_position_index.load(),
+                   {line->stats.get_score(), line->stats.depth, m_search_tree.get_best_move()});
+    std::ofstream out(m_config.pgn_output, std::ios::out | std::ios::trunc);
+    if (out.is_open()) {
+        m_game->write_pgn(out);
+    }
+}
+
+void Application::seed_from_cache() {
+    for (auto& depth : m_cached_line_depths) {
+        depth.store(0);
+    }
+    auto entry = m_cache ? m_cache->lookup(m_root_key) : std::nullopt;
+    if (!entry) {
+        return;
+    }
+    u16 line_count = std::min<u16>(static_cast<u16>(entry->lines.size()), m_config.multi_pv);
+    for (u16 i = 0; i < line_count; ++i) {
+        auto& line = entry->lines[i];
+        uci::InfoData info;
+        info.depth = line.depth;
+        info.score = line.score;
+        info.wdl = line.wdl;
+        info.multipv = static_cast<u16>(i + 1);
+        info.pv = std::move(line.pv);
+        m_search_tree.update(info);
+        m_cached_line_depths[i].store(line.depth);
+    }
+    m_cache->flush();
+    request_frame();
+}
+
+bool Application::is_cached(u64 position_index) const {
+    if (!m_cache || m_config.max_depth == 0 || m_game) {
+        return false;
+    }
+    try {
+        auto key = chess::Position::from_string(m_config.positions[position_index]).key();
+        return m_cache->cached_depth(key) >= m_config.max_depth;
+    } catch (const std::exception&) {
+        return false;
     }
 }
 
 void Application::start_search() {
     m_search_start_time = std::chrono::steady_clock::now();
+    m_convergence_reset.store(true);
+    m_converged_depth.store(0);
     
-    std::string go_cmd = "go";
-    if (m_config.max_depth > 0) {
-        go_cmd += " depth " + std::to_string(m_config.max_depth);
-    } else {
-        go_cmd += " infinite";
+    std::string limits =
+            m_config.max_depth > 0 ? "depth " + std::to_string(m_config.max_depth) : "infinite";
+    send_command("go " + limits);
+    m_search_running.store(true);
+    for (auto& session : m_comparisons) {
+        session->go(limits);
     }
-    
-    m_uci_client->send_command(go_cmd);
 }
 
 void Application::stop_search() {
-    m_uci_client->send_command("stop");
+    send_command("stop");
+    for (auto& session : m_comparisons) {
+        session->halt();
+    }
+}
+
+void Application::advance_position() {
+    u64 next = m_position_index.load() + 1;
+    while (next < m_config.positions.size() && is_cached(next)) {
+        next++;
+    }
+    if (next >= m_config.positions.size()) {
+        return;
+    }
+
+    // A game stays on one engine so its hash carries over between plies; a
+    // search cut short must end before the next position is sent.
+    if (m_game) {
+        record_game_ply();
+        if (m_search_running.exchange(false)) {
+            // This thread reads the engine's lines itself, so a loop is set up
+            // only to wait out the search.
+            send_command("stop");
+            uci::EventLoop loop;
+            loop.watch(*m_uci_client);
+            loop.run(m_uci_client->expect("bestmove", BESTMOVE_TIMEOUT));
+        }
+        m_position_index.store(next);
+        clear_tree();
+        send_position();
+        if (!m_is_paused.load()) {
+            start_search();
+        }
+        return;
+    }
+
+    std::unique_ptr<uci::UciClient> previous;
+    {
+        std::lock_guard<std::mutex> lock(m_engine_mutex);
+        previous = std::move(m_uci_client);
+    }
+    m_engine_pool->release(std::move(previous));
+
+    std::unique_ptr<uci::UciClient> client;
+    while (!client && !m_is_shutting_down.load()) {
+        try {
+            client = m_engine_pool->acquire(std::chrono::milliseconds(100));
+        } catch (const std::exception&) {
+            client = nullptr;
+        }
+        if (!client && m_engine_pool->has_failed()) {
+            shutdown();
+            return;
+        }
+    }
+    if (!client) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_engine_mutex);
+        m_uci_client = std::move(client);
+    }
+    m_output_queue.store(m_uci_client->share_output_queue());
+    m_pipe_counters.store(m_uci_client->share_pipe_counters());
+    m_resource_sampler.set_engine_pid(m_uci_client->pid());
+    m_position_index.store(next);
+    clear_tree();
+    send_position();
+    if (!m_is_paused.load()) {
+        start_search();
+    }
 }
 
 i32 Application::run(i32 argc, char* argv[]) {
@@ -281,6 +957,17 @@ i32 Application::run(i32 argc, char* argv[]) {
 
     setup_signal_handlers();
 
+    if (m_config.proxy) {
+        // Before anything is printed: stdout is now the GUI's protocol stream.
+        try {
+            m_gui = process::detach_console(m_config.proxy_tty);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        m_headless = m_config.proxy_tty.empty();
+    }
+
     if (m_config.enable_logging) {
         m_log_file.open("vgce_engine_log.txt", std::ios::out | std::ios::trunc);
     }
@@ -290,21 +977,132 @@ i32 Application::run(i32 argc, char* argv[]) {
     }
 
     try {
-        m_process = std::make_unique<process::Process>(m_config.engine_path, std::vector<std::string>{});
-        m_uci_client = std::make_unique<uci::UciClient>(std::move(m_process));
+        if (!m_config.replay_path.empty()) {
+            m_replay = std::make_unique<session::SessionReader>(m_config.replay_path);
+            m_global_stats.engine_name = m_replay->engine_name() + " (replay)";
+        } else if (!m_config.connect_path.empty()) {
+            m_viewer = std::make_unique<session::SessionClient>(m_config.connect_path);
+            m_global_stats.engine_name = m_viewer->engine_name() + " (viewer)";
+        } else {
+            uci::EngineConfig engine_config;
+            engine_config.executable = m_config.engine_path;
+            engine_config.placement = m_config.engine_placement;
+            engine_config.reader_placement = m_config.ui_placement;
+            engine_config.pipe_size = m_config.pipe_size;
+            // Behind a GUI the engine gets the GUI's options and nothing else.
+            if (!m_config.proxy) {
+                engine_config.setup_commands = build_setup_commands();
+            }
+            m_engine_pool = std::make_unique<uci::EnginePool>(
+                engine_config, m_config.proxy ? 0 : m_config.engine_spares);
+
+            m_uci_client = m_engine_pool->acquire(std::chrono::seconds(60));
+            if (!m_uci_client) {
+                throw std::runtime_error("Engine did not complete the UCI handshake");
+            }
+            m_global_stats.engine_name = m_uci_client->engine_name();
+            m_output_queue.store(m_uci_client->share_output_queue());
+            m_pipe_counters.store(m_uci_client->share_pipe_counters());
+            if (m_config.proxy) {
+                // Our own handshake is consumed by now; from here on the GUI
+                // sees everything the engine writes.
+                m_uci_client->mirror_output(m_gui.output, &m_latency.engine_to_gui);
+                m_global_stats.engine_name += " (proxy)";
+            }
+            m_resource_sampler.set_engine_pid(m_uci_client->pid());
+            if (m_config.refine_engines > 0) {
+                m_refiner = std::make_unique<Refiner>(engine_config, m_config.refine_engines,
+                                                      m_config.refine_depth, m_search_tree,
+                                                      [this] { request_frame(); });
+            }
+            for (const auto& path : m_config.compare_engines) {
+                uci::EngineConfig compare_config = engine_config;
+                compare_config.executable = path;
+                auto session = std::make_unique<EngineSession>(
+                    std::move(compare_config), m_config.engine_spares, m_config.merge_transpositions,
+                    static_cast<u64>(m_config.tree_memory_mb) * 1024 * 1024, [this] { request_frame(); });
+                session->start();
+                m_comparisons.push_back(std::move(session));
+            }
+            if (!m_config.cache_path.empty()) {
+                m_cache = std::make_unique<session::AnalysisCache>(m_config.cache_path);
+            }
+            if (!m_config.record_path.empty()) {
+                m_recorder = std::make_unique<session::SessionRecorder>(m_config.record_path,
+                                                                        m_global_stats.engine_name);
+            }
+            if (!m_config.serve_path.empty()) {
+                m_server = std::make_unique<session::SessionServer>(m_config.serve_path,
+                                                                    m_global_stats.engine_name, m_search_tree);
+            }
+        }
+        if (!m_config.shm_name.empty()) {
+            m_snapshot = std::make_unique<session::SnapshotPublisher>(
+                m_config.shm_name, m_global_stats.engine_name, m_global_stats, m_search_tree);
+        }
+        if (m_config.metrics_port || !m_config.metrics_file.empty()) {
+            m_metrics = std::make_unique<MetricsExporter>(
+                MetricsSources{m_global_stats.engine_name, m_global_stats, m_counters, m_latency,
+                               [this] { return queue_stats(); }},
+                m_config.metrics_port, m_config.metrics_file,
+                std::chrono::milliseconds(m_config.metrics_interval_ms));
+        }
+        if (m_config.stats_interval_ms > 0) {
+            m_resource_sampler.start(std::chrono::milliseconds(m_config.stats_interval_ms));
+        }
+
+        m_convergence = model::ConvergenceDetector(m_config.stop_rule);
+        m_search_tree.set_merge_transpositions(m_config.merge_transpositions);
+        m_search_tree.set_memory_budget(static_cast<u64>(m_config.tree_memory_mb) * 1024 * 1024);
         m_renderer = std::make_unique<tui::Renderer>(
             m_search_tree, m_global_stats, m_screen, m_config, m_search_start_time, *this);
 
-        m_uci_client->start();
-        std::thread uci_thread(&Application::uci_processing_loop, this);
+        if (!m_config.ui_placement.empty() &&
+            !process::apply_to_current_thread(m_config.ui_placement)) {
+            std::cerr << "Warning: Failed to apply UI thread placement\n";
+        }
+
+        auto processing_loop = m_replay          ? &Application::replay_loop
+                               : m_viewer       ? &Application::viewer_loop
+                               : m_config.proxy ? &Application::proxy_loop
+                                                : &Application::uci_processing_loop;
+        std::thread uci_thread(processing_loop, this);
+        std::thread gui_thread;
+        if (m_config.proxy) {
+            gui_thread = std::thread(&Application::gui_input_loop, this);
+        }
 
-        m_renderer->start();
+        if (m_headless) {
+            headless_loop();
+        } else {
+            m_renderer->start();
+        }
 
         m_is_shutting_down.store(true);
-        m_uci_client->stop();
         if (uci_thread.joinable()) {
             uci_thread.join();
         }
+        if (gui_thread.joinable()) {
+            gui_thread.join();
+        }
+        m_resource_sampler.stop();
+        m_recorder.reset();
+        m_server.reset();
+        m_snapshot.reset();
+        m_metrics.reset();
+        m_comparisons.clear();
+        m_refiner.reset();
+        metrics::trace::dump("vgce_trace.json");
+        if (m_config.enable_logging) {
+            std::ofstream report("vgce_latency_report.txt", std::ios::out | std::ios::trunc);
+            metrics::write_report(report, m_latency);
+        }
+        if (m_uci_client) {
+            m_uci_client->stop();
+        }
+        if (m_engine_pool) {
+            m_engine_pool->shutdown();
+        }
 
     } catch (const std::exception& e) {
         std::cerr << "\nError: " << e.what() << std::endl;
@@ -314,23 +1112,17 @@ i32 Application::run(i32 argc, char* argv[]) {
 }
 
 void Application::uci_processing_loop() {
-    m_uci_client->send_command("uci");
-    bool uci_ok = false;
-    
-    while (!uci_ok && !m_is_shutting_down) {
-        if (auto line = m_uci_client->get_output_queue().pop()) {
-            constexpr u64 ID_NAME_PREFIX_LEN = 8;
-            if (line->find("id name ") == 0 && line->length() > ID_NAME_PREFIX_LEN) {
-                m_global_stats.engine_name = line->substr(ID_NAME_PREFIX_LEN);
-            }
-            if (*line == "uciok") {
-                uci_ok = true;
-            }
-        }
+    if (!m_config.ui_placement.empty()) {
+        process::apply_to_current_thread(m_config.ui_placement);
     }
-    
-    m_uci_client->send_command("isready");
-    send_uci_options();
+    VGCE_TRACE_THREAD("processing");
+
+    // The last position is analysed even if cached, so there is always one.
+    u64 first = 0;
+    while (first + 1 < m_config.positions.size() && is_cached(first)) {
+        first++;
+    }
+    m_position_index.store(first);
     send_position();
     
     if (!m_config.pause_on_start) {
@@ -338,55 +1130,330 @@ void Application::uci_processing_loop() {
     }
 
     while (!m_is_shutting_down.load()) {
-        auto line = m_uci_client->get_output_queue().pop();
+        if (m_advance_requested.exchange(false)) {
+            advance_position();
+            continue;
+        }
+        if (m_convergence_reset.exchange(false)) {
+            m_convergence.reset();
+        }
+
+        auto line = m_uci_client->get_output_queue().wait_and_pop(std::chrono::milliseconds(10));
         if (!line) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
             continue;
         }
 
         if (m_log_file.is_open()) {
             std::lock_guard<std::mutex> lock(m_log_mutex);
-            m_log_file << *line << std::endl;
+            m_log_file << line->text << std::endl;
         }
 
-        auto info = uci::parse_line(*line);
-        if (info) {
-            if (info->nodes) {
-                m_global_stats.nodes.store(*info->nodes);
-            }
-            if (info->nps) {
-                m_global_stats.nps.store(*info->nps);
-            }
-            if (info->hashfull) {
-                m_global_stats.hashfull.store(*info->hashfull);
+        // A search that finished on its own moves a position queue along.
+        if (line->text.starts_with("bestmove")) {
+            m_search_running.store(false);
+            if ((m_config.max_depth > 0 || m_convergence.has_fired()) && !m_is_paused.load()) {
+                if (m_position_index.load() + 1 < m_config.positions.size()) {
+                    advance_position();
+                    continue;
+                }
+                if (m_game) {
+                    record_game_ply();
+                }
             }
-            if (info->tbhits) {
-                m_global_stats.tbhits.store(*info->tbhits);
+        }
+
+        VGCE_TRACE_SCOPE("process_line");
+        auto info = uci::parse_line(line->text);
+        if (info) {
+            info->read_ns = line->read_ns;
+            info->parse_ns = metrics::monotonic_ns();
+            m_latency.read_to_parse.record(info->parse_ns - info->read_ns);
+            // A line shallower than its cached one would only replace it with a worse one.
+            u16 multipv = info->multipv.value_or(1);
+            if (info->depth && multipv >= 1 && multipv <= m_cached_line_depths.size() &&
+                *info->depth < m_cached_line_depths[multipv - 1].load()) {
+                info->pv.clear();
             }
-            if (info->time) {
-                m_global_stats.time_ms.store(*info->time);
+            handle_info(*info);
+            if (m_cache) {
+                m_cache->store(m_root_key, *info);
             }
-            if (info->wdl) {
-                m_global_stats.wdl_stats = *info->wdl;
+            publish_info(*info);
+            if (info->multipv.value_or(1) == 1 && m_convergence.observe(*info)) {
+                m_converged_depth.store(*info->depth);
+                stop_search();
             }
-            if (info->static_eval) {
-                m_global_stats.static_eval = *info->static_eval;
+        }
+    }
+}
+
+void Application::proxy_loop() {
+    if (!m_config.ui_placement.empty()) {
+        process::apply_to_current_thread(m_config.ui_placement);
+    }
+    VGCE_TRACE_THREAD("processing");
+
+    while (!m_is_shutting_down.load()) {
+        auto line = m_uci_client->get_output_queue().wait_and_pop(std::chrono::milliseconds(10));
+        // GUI commands forwarded before this line was read go first, so a
+        // new position is in place before the search's first info.
+        while (auto command = m_gui_commands.pop()) {
+            apply_gui_command(*command);
+        }
+        if (!line) {
+            if (!m_uci_client->is_running()) {
+                shutdown();
             }
-            if (info->multipv) {
-                m_global_stats.current_multipv = *info->multipv;
+            continue;
+        }
+
+        if (m_log_file.is_open()) {
+            std::lock_guard<std::mutex> lock(m_log_mutex);
+            m_log_file << line->text << std::endl;
+        }
+        if (line->text.starts_with("bestmove")) {
+            m_search_running.store(false);
+        }
+
+        VGCE_TRACE_SCOPE("process_line");
+        auto info = uci::parse_line(line->text);
+        if (info) {
+            info->read_ns = line->read_ns;
+            info->parse_ns = metrics::monotonic_ns();
+            m_latency.read_to_parse.record(info->parse_ns - info->read_ns);
+            handle_info(*info);
+            publish_info(*info);
+        }
+    }
+}
+
+void Application::gui_input_loop() {
+    if (!m_config.ui_placement.empty()) {
+        process::apply_to_current_thread(m_config.ui_placement);
+    }
+    VGCE_TRACE_THREAD("gui");
+
+    std::string pending;
+    while (!m_is_shutting_down.load()) {
+        if (m_uci_client->forward_input(m_gui.input, pending, &m_latency.gui_to_engine) < 0) {
+            // A GUI that hangs up without quit would leave the engine searching.
+            m_uci_client->send_command("quit");
+            shutdown();
+            break;
+        }
+        u64 start = 0;
+        for (auto end = pending.find('\n'); end != std::string::npos; end = pending.find('\n', start)) {
+            std::string command = pending.substr(start, end - start);
+            if (!command.empty() && command.back() == '\r') {
+                command.pop_back();
             }
-            if (!info->currmove.empty()) {
-                m_global_stats.current_move = info->currmove;
+            m_gui_commands.push(std::move(command));
+            start = end + 1;
+        }
+        pending.erase(0, start);
+    }
+}
+
+void Application::apply_gui_command(const std::string& command) {
+    if (m_log_file.is_open()) {
+        std::lock_guard<std::mutex> lock(m_log_mutex);
+        m_log_file << "> " << command << std::endl;
+    }
+    if (command.starts_with("position ")) {
+        // GUIs repeat the position before every go; only a new root resets the tree.
+        auto root = parse_position_command(command);
+        if (!root || root->key() == m_root_key) {
+            return;
+        }
+        clear_tree();
+        m_root_key = root->key();
+        m_search_tree.set_root_position(*root);
+        publish_root_change();
+        request_frame();
+    } else if (command == "ucinewgame") {
+        clear_tree();
+        m_root_key = 0;
+    } else if (command == "go" || command.starts_with("go ")) {
+        reset_search_stats();
+        m_search_start_time = std::chrono::steady_clock::now();
+        m_search_running.store(true);
+    }
+}
+
+// Without a terminal to draw on, each new depth of the main line goes to
+// stderr, which GUIs keep in their engine logs.
+void Application::headless_loop() {
+    u16 reported_depth = 0;
+    while (!m_is_shutting_down.load()) {
+        std::this_thread::sleep_for(HEADLESS_INTERVAL);
+        u16 depth = m_global_stats.main_depth.load();
+        if (depth == reported_depth) {
+            continue;
+        }
+        reported_depth = depth;
+        auto line = m_search_tree.get_main_line();
+        if (depth == 0 || !line || !line->stats.has_score) {
+            continue;
+        }
+        std::cerr << "vgce: depth " << depth << " " << format_headless_score(line->stats.get_score())
+                  << " " << line->moves << " | nps " << m_global_stats.nps.load()
+                  << " | engine->gui p99 " << metrics::format_duration(m_latency.engine_to_gui.percentile(0.99))
+                  << "\n";
+    }
+}
+
+void Application::handle_info(uci::InfoData& info) {
+    metrics::bump(m_counters.infos_parsed);
+    record_search_stats(m_global_stats, info);
+
+    if (!info.pv.empty()) {
+        m_search_tree.update(info);
+        m_latency.parse_to_tree.record(metrics::monotonic_ns() - info.parse_ns);
+        metrics::bump(m_counters.tree_updates);
+    }
+    request_frame();
+    metrics::bump(m_counters.frames_requested);
+}
+
+// Session time follows the wall clock while not paused; seeks jump it.
+void Application::replay_loop() {
+    if (!m_config.ui_placement.empty()) {
+        process::apply_to_current_thread(m_config.ui_placement);
+    }
+    VGCE_TRACE_THREAD("replay");
+
+    u64 offset = m_replay->first_offset();
+    u64 cursor_ns = 0;
+    if (m_config.replay_start) {
+        seek_replay(*m_config.replay_start);
+    }
+    u64 last_tick_ns = metrics::monotonic_ns();
+
+    while (!m_is_shutting_down.load()) {
+        std::optional<ReplayTarget> target;
+        {
+            std::lock_guard<std::mutex> lock(m_seek_mutex);
+            target.swap(m_seek_request);
+        }
+        if (target) {
+            cursor_ns = seek_session(*target, offset, cursor_ns);
+        }
+
+        u64 now_ns = metrics::monotonic_ns();
+        if (!m_is_paused.load()) {
+            cursor_ns = std::min(cursor_ns + (now_ns - last_tick_ns), m_replay->duration_ns());
+        }
+        last_tick_ns = now_ns;
+
+        while (auto record = m_replay->read(offset)) {
+            if (record->time_ns > cursor_ns) {
+                break;
             }
-            if (info->currmovenumber) {
-                m_global_stats.current_move_number = *info->currmovenumber;
+            apply_session_record(record->type, record->body);
+            offset = record->next;
+        }
+
+        m_replay_cursor_ns.store(cursor_ns);
+        m_replay_depth.store(m_replay->depth_at(offset - 1));
+        m_search_start_time = std::chrono::steady_clock::now() - std::chrono::nanoseconds(cursor_ns);
+        request_frame();
+        std::this_thread::sleep_for(REPLAY_TICK);
+    }
+}
+
+// The tree is rebuilt from the server's checkpoints and lines, as a replay
+// would, and the viewer quits when the server does.
+void Application::viewer_loop() {
+    if (!m_config.ui_placement.empty()) {
+        process::apply_to_current_thread(m_config.ui_placement);
+    }
+    VGCE_TRACE_THREAD("viewer");
+
+    while (!m_is_shutting_down.load()) {
+        auto record = m_viewer->read(std::chrono::milliseconds(10));
+        if (!record) {
+            if (!m_viewer->is_connected()) {
+                shutdown();
             }
+            continue;
+        }
+        apply_session_record(record->type, record->body);
+        request_frame();
+    }
+}
+
+u64 Application::seek_session(const ReplayTarget& target, u64& offset, u64 cursor_ns) {
+    VGCE_TRACE_SCOPE("replay.seek");
+    auto clamp_time = [&](i64 time_ns) {
+        return static_cast<u64>(std::clamp<i64>(time_ns, 0, static_cast<i64>(m_replay->duration_ns())));
+    };
+
+    // Depth targets stop at a record, time targets at a moment.
+    std::optional<u64> goal_offset;
+    u64 goal_ns = cursor_ns;
+    switch (target.kind) {
+    case ReplayTarget::Kind::Time:
+        goal_ns = clamp_time(target.value);
+        break;
+    case ReplayTarget::Kind::TimeDelta:
+        goal_ns = clamp_time(static_cast<i64>(cursor_ns) + target.value);
+        break;
+    case ReplayTarget::Kind::Depth:
+    case ReplayTarget::Kind::DepthDelta: {
+        i64 depth = target.value;
+        if (target.kind == ReplayTarget::Kind::DepthDelta) {
+            depth += m_replay->depth_at(offset - 1);
+        }
+        const auto* entry = m_replay->depth_reached(offset - 1, static_cast<u16>(std::clamp<i64>(depth, 1, 65535)));
+        if (!entry) {
+            return cursor_ns;
+        }
+        goal_offset = entry->offset;
+        goal_ns = entry->time_ns;
+        break;
+    }
+    }
 
-            if (!info->pv.empty()) {
-                m_search_tree.update(*info);
+    const auto* checkpoint = goal_offset ? m_replay->checkpoint_at_offset(*goal_offset)
+                                         : m_replay->checkpoint_at_time(goal_ns);
+    reset_search_stats();
+    offset = m_replay->first_offset();
+    m_search_tree.clear();
+    if (checkpoint) {
+        // An index entry can point past a truncated recording.
+        if (auto record = m_replay->read(checkpoint->offset); record && !record->body.empty()) {
+            try {
+                m_search_tree.restore(record->body.subspan(1));
+            } catch (const std::exception&) {
+                // Left empty; the lines after the checkpoint still rebuild part of it.
             }
-            m_screen.PostEvent(ftxui::Event::Custom);
+            offset = record->next;
+        }
+    }
+
+    while (auto record = m_replay->read(offset)) {
+        if (goal_offset ? record->offset > *goal_offset : record->time_ns > goal_ns) {
+            break;
+        }
+        apply_session_record(record->type, record->body);
+        offset = record->next;
+    }
+    return goal_ns;
+}
+
+void Application::apply_session_record(session::RecordType type, std::span<const u8> body) {
+    try {
+        if (type == session::RecordType::Info) {
+            auto info = session::decode_info(body);
+            info.read_ns = info.parse_ns = metrics::monotonic_ns();
+            handle_info(info);
+        } else if (type == session::RecordType::Checkpoint && !body.empty() && body[0]) {
+            // Periodic checkpoints repeat the state already built; root changes start over.
+            reset_search_stats();
+            m_search_tree.restore(body.subspan(1));
         }
+    } catch (const std::exception&) {
+        // A damaged record is skipped.
     }
 }
 
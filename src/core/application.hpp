@@ -1,11 +1,27 @@
 #pragma once
 
+#include "core/engine_session.hpp"
+#include "core/game_analysis.hpp"
+#include "core/metrics_exporter.hpp"
+#include "core/refiner.hpp"
+#include "core/resource_sampler.hpp"
 #include "ftxui/component/screen_interactive.hpp"
+#include "metrics/latency_histogram.hpp"
+#include "metrics/pipeline_counters.hpp"
+#include "model/convergence.hpp"
 #include "model/search_tree.hpp"
+#include "session/analysis_cache.hpp"
+#include "session/session_client.hpp"
+#include "session/session_reader.hpp"
+#include "session/session_recorder.hpp"
+#include "session/session_server.hpp"
+#include "session/snapshot_publisher.hpp"
+#include "uci/engine_pool.hpp"
 #include "uci/uci_client.hpp"
 #include <chrono>
 #include <fstream>
 #include <mutex>
+#include <optional>
 
 namespace vgce::tui {
 class Renderer;
@@ -13,6 +29,15 @@ class Renderer;
 
 namespace vgce::core {
 
+// A point in a replayed session to jump to; deltas are from the current one.
+struct ReplayTarget {
+    enum class Kind : u8 { Time, Depth, TimeDelta, DepthDelta };
+
+    Kind kind = Kind::Time;
+    // Nanoseconds for times, plies for depths.
+    i64 value = 0;
+};
+
 struct AppConfig {
     std::filesystem::path engine_path;
     std::string position_fen = "startpos";
@@ -27,6 +52,46 @@ struct AppConfig {
     bool pause_on_start = false;
 
     std::vector<std::string> custom_uci_options;
+
+    // Positions analysed one after another; defaults to just position_fen.
+    std::vector<std::string> positions;
+    u16 engine_spares = 0;
+    u64 pipe_size = process::DEFAULT_PIPE_SIZE;
+    u32 stats_interval_ms = 1000;
+    // Prometheus text-format export on 127.0.0.1:metrics_port and/or to
+    // metrics_file every metrics_interval_ms.
+    std::optional<u16> metrics_port;
+    std::filesystem::path metrics_file;
+    u32 metrics_interval_ms = 5000;
+    u32 latency_budget_ms = 0;
+    bool merge_transpositions = false;
+    u32 tree_memory_mb = 0;
+    model::StopRule stop_rule;
+    std::filesystem::path record_path;
+    std::filesystem::path cache_path;
+    // Engines for searching single tree nodes, and how deep they go.
+    u16 refine_engines = 1;
+    u16 refine_depth = 24;
+    // Where --pgn writes the annotated game.
+    std::filesystem::path pgn_output;
+    // Engines run alongside the main one on the same positions.
+    std::vector<std::filesystem::path> compare_engines;
+    // Replays a recorded session instead of running an engine.
+    std::filesystem::path replay_path;
+    std::optional<ReplayTarget> replay_start;
+    // Streams the session to viewers on this local socket.
+    std::filesystem::path serve_path;
+    // Follows another vgce's --serve socket instead of running an engine.
+    std::filesystem::path connect_path;
+    // Publishes a live snapshot in shared memory under this name.
+    std::string shm_name;
+    // Stands between a GUI and the engine; the viewer draws on proxy_tty, or
+    // prints a line per depth to stderr without one.
+    bool proxy = false;
+    std::filesystem::path proxy_tty;
+
+    process::Placement engine_placement;
+    process::Placement ui_placement;
 };
 
 class Application {
@@ -39,23 +104,105 @@ public:
     void toggle_pause();
     void clear_tree();
     void export_tree();
+    void dump_trace();
+    void next_position();
     bool is_paused() const;
+    // Depth at which the stop rule ended the current search, 0 if it has not.
+    u16 converged_depth() const;
+
+    const std::string& current_position() const;
+    u64 position_index() const;
+    u64 position_count() const;
+    metrics::PipelineLatency& latency();
+    process::PipeStats pipe_stats();
+    metrics::QueueStats queue_stats();
+    metrics::PipelineCounters& counters();
+    const std::vector<std::unique_ptr<EngineSession>>& comparisons() const;
+    // Searches the node reached by path (UCI moves from the root) on a
+    // refinement engine. Returns false if none is free.
+    bool refine_node(std::vector<std::string> path);
+    u16 refinements_running() const;
+
+    bool is_replaying() const;
+    void seek_replay(const ReplayTarget& target);
+    u64 replay_cursor_ns() const;
+    u64 replay_duration_ns() const;
+    u16 replay_depth() const;
 
 private:
     void uci_processing_loop();
+    void replay_loop();
+    void viewer_loop();
+    // Proxy mode: the GUI's commands reach the engine from gui_input_loop,
+    // the engine's output reaches the GUI from the reader thread, and
+    // proxy_loop only mirrors both into the tree.
+    void proxy_loop();
+    void gui_input_loop();
+    void apply_gui_command(const std::string& command);
+    void headless_loop();
+    void request_frame();
+    void handle_info(uci::InfoData& info);
+    void reset_search_stats();
+    // Rebuilds the tree at the target from the nearest checkpoint; returns
+    // the new session time and moves offset past the last applied record.
+    u64 seek_session(const ReplayTarget& target, u64& offset, u64 cursor_ns);
+    void apply_session_record(session::RecordType type, std::span<const u8> body);
+    // Hands lines and root changes to the recorder and the viewers, if any.
+    void publish_info(const uci::InfoData& info);
+    void publish_root_change();
     void setup_signal_handlers();
     void parse_arguments(i32 argc, char* argv[]);
+    bool load_positions(const std::filesystem::path& path);
+    bool load_game(const std::filesystem::path& path);
+    // Keeps the finished ply's eval and rewrites the annotated game.
+    void record_game_ply();
     void print_usage(const char* program_name);
     void print_help();
     void send_position();
-    void send_uci_options();
+    std::vector<std::string> build_setup_commands() const;
+    void send_command(std::string_view command);
     void start_search();
     void stop_search();
+    void advance_position();
+    // Shows the cached lines for the new root and holds back shallower ones.
+    void seed_from_cache();
+    // True when --max-depth is set and the position is cached at least that deep.
+    bool is_cached(u64 position_index) const;
 
-    std::unique_ptr<process::Process> m_process;
+    std::unique_ptr<uci::EnginePool> m_engine_pool;
     std::unique_ptr<uci::UciClient> m_uci_client;
+    std::vector<std::unique_ptr<EngineSession>> m_comparisons;
+    std::unique_ptr<GameAnalysis> m_game;
+    std::unique_ptr<Refiner> m_refiner;
+    std::mutex m_engine_mutex;
+    // The current client's output queue and pipe counters, for queue_stats()
+    // and pipe_stats().
+    std::atomic<std::shared_ptr<const ConcurrentQueue<process::Line>>> m_output_queue;
+    std::atomic<std::shared_ptr<const process::PipeCounters>> m_pipe_counters;
     model::SearchTree m_search_tree;
     uci::GlobalStats m_global_stats;
+    ResourceSampler m_resource_sampler{m_global_stats};
+    metrics::PipelineLatency m_latency;
+    metrics::PipelineCounters m_counters;
+    // Only touched by the processing thread.
+    model::ConvergenceDetector m_convergence;
+    std::unique_ptr<session::SessionRecorder> m_recorder;
+    std::unique_ptr<session::SessionServer> m_server;
+    std::unique_ptr<session::SnapshotPublisher> m_snapshot;
+    std::unique_ptr<MetricsExporter> m_metrics;
+    std::unique_ptr<session::SessionClient> m_viewer;
+    std::unique_ptr<session::AnalysisCache> m_cache;
+    u64 m_root_key = 0;
+    // Per MultiPV slot, the cached depth live lines must reach to be shown.
+    std::array<std::atomic<u16>, session::AnalysisCache::MAX_LINES> m_cached_line_depths{};
+    std::unique_ptr<session::SessionReader> m_replay;
+    std::mutex m_seek_mutex;
+    std::optional<ReplayTarget> m_seek_request;
+    std::atomic<u64> m_replay_cursor_ns{0};
+    std::atomic<u16> m_replay_depth{0};
+    process::ConsoleStreams m_gui;
+    ConcurrentQueue<std::string> m_gui_commands;
+    bool m_headless = false;
 
     ftxui::ScreenInteractive m_screen = ftxui::ScreenInteractive::Fullscreen();
     std::unique_ptr<tui::Renderer> m_renderer;
@@ -65,6 +212,12 @@ private:
 
     std::atomic<bool> m_is_shutting_down{false};
     std::atomic<bool> m_is_paused{false};
+    std::atomic<bool> m_advance_requested{false};
+    // Between a go and its bestmove.
+    std::atomic<bool> m_search_running{false};
+    std::atomic<bool> m_convergence_reset{false};
+    std::atomic<u16> m_converged_depth{0};
+    std::atomic<u64> m_position_index{0};
     std::chrono::steady_clock::time_point m_search_start_time;
     
     AppConfig m_config;
@@ -0,0 +1,215 @@
+#include "core/engine_session.hpp"
+#include "chess/position.hpp"
+#include "metrics/trace.hpp"
+#include "uci/uci_parser.hpp"
+#include <stdexcept>
+
+namespace vgce::core {
+
+namespace {
+
+constexpr auto POLL_INTERVAL = std::chrono::milliseconds(10);
+constexpr auto ACQUIRE_TIMEOUT = std::chrono::seconds(60);
+constexpr auto BESTMOVE_TIMEOUT = std::chrono::seconds(5);
+
+} // namespace
+
+void record_search_stats(uci::GlobalStats& stats, const uci::InfoData& info) {
+    if (info.nodes) {
+        stats.nodes.store(*info.nodes);
+    }
+    if (info.nps) {
+        stats.nps.store(*info.nps);
+    }
+    if (info.hashfull) {
+        stats.hashfull.store(*info.hashfull);
+    }
+    if (info.tbhits) {
+        stats.tbhits.store(*info.tbhits);
+    }
+    if (info.time) {
+        stats.time_ms.store(*info.time);
+    }
+    if (info.wdl) {
+        stats.wdl_stats = *info.wdl;
+    }
+    if (info.static_eval) {
+        stats.static_eval = *info.static_eval;
+    }
+    if (info.multipv) {
+        stats.current_multipv = *info.multipv;
+    }
+    if (!info.currmove.empty()) {
+        stats.current_move = info.currmove;
+    }
+    if (info.currmovenumber) {
+        stats.current_move_number = *info.currmovenumber;
+    }
+    if (info.depth && *info.depth > stats.main_depth.load() && info.multipv.value_or(1) == 1 && !info.pv.empty()) {
+        stats.main_depth.store(*info.depth);
+        if (*info.depth < uci::MAX_TIMED_DEPTH) {
+            stats.depth_time_ms[*info.depth].store(static_cast<u32>(info.time.value_or(0)));
+        }
+    }
+    if (info.score && info.multipv.value_or(1) == 1 && !info.pv.empty()) {
+        stats.main_score_cp.store(info.score->to_cp());
+        stats.main_mate.store(info.score->type == uci::Score::Type::Mate ? info.score->value : 0);
+    }
+}
+
+void clear_search_stats(uci::GlobalStats& stats) {
+    stats.nodes.store(0);
+    stats.nps.store(0);
+    stats.hashfull.store(0);
+    stats.tbhits.store(0);
+    stats.time_ms.store(0);
+    stats.main_depth.store(0);
+    stats.main_score_cp.store(0);
+    stats.main_mate.store(0);
+    for (auto& time : stats.depth_time_ms) {
+        time.store(0);
+    }
+}
+
+EngineSession::EngineSession(uci::EngineConfig config, u16 spare_count, bool merge_transpositions,
+                             u64 memory_budget, std::function<void()> on_update)
+        : m_pool(std::move(config), spare_count), m_on_update(std::move(on_update)) {
+    m_tree.set_merge_transpositions(merge_transpositions);
+    m_tree.set_memory_budget(memory_budget);
+}
+
+EngineSession::~EngineSession() {
+    stop();
+}
+
+void EngineSession::start() {
+    m_client = m_pool.acquire(ACQUIRE_TIMEOUT);
+    if (!m_client) {
+        throw std::runtime_error("Comparison engine did not complete the UCI handshake");
+    }
+    m_stats.engine_name = m_client->engine_name();
+    m_loop.watch(*m_client, [this](const process::Line& line) { handle_line(line); });
+    m_is_running.store(true);
+    m_thread = std::thread(&EngineSession::run, this);
+}
+
+void EngineSession::stop() {
+    m_is_running.store(false);
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    if (m_client) {
+        m_loop.unwatch(*m_client);
+        m_client->stop();
+        m_client.reset();
+    }
+    m_pool.shutdown();
+}
+
+void EngineSession::set_position(const std::string& position) {
+    m_commands.push({Command::Kind::Position, position});
+}
+
+void EngineSession::go(const std::string& limits) {
+    m_commands.push({Command::Kind::Go, limits});
+}
+
+void EngineSession::halt() {
+    m_commands.push({Command::Kind::Stop, {}});
+}
+
+void EngineSession::clear() {
+    m_commands.push({Command::Kind::Clear, {}});
+}
+
+void EngineSession::run() {
+    VGCE_TRACE_THREAD("compare");
+    while (m_is_running.load()) {
+        while (auto command = m_commands.pop()) {
+            execute(*command);
+        }
+        if (!m_client) {
+            if (auto command = m_commands.wait_and_pop(POLL_INTERVAL)) {
+                execute(*command);
+            }
+            continue;
+        }
+        m_loop.poll();
+    }
+}
+
+void EngineSession::execute(const Command& command) {
+    switch (command.kind) {
+    case Command::Kind::Position:
+        if (m_has_searched) {
+            finish_search();
+            m_loop.unwatch(*m_client);
+            m_pool.release(std::move(m_client));
+            while (!m_client && m_is_running.load() && !m_pool.has_failed()) {
+                try {
+                    m_client = m_pool.acquire(std::chrono::milliseconds(100));
+                } catch (const std::exception&) {
+                    m_client = nullptr;
+                }
+            }
+            if (!m_client) {
+                m_has_failed.store(true);
+                return;
+            }
+            m_loop.watch(*m_client, [this](const process::Line& line) { handle_line(line); });
+            m_has_searched = false;
+        }
+        clear_search_stats(m_stats);
+        m_tree.set_root_position(chess::Position::from_string(command.text));
+        m_client->send_command(command.text == "startpos" ? "position startpos" : "position fen " + command.text);
+        break;
+    case Command::Kind::Go:
+        if (m_client) {
+            finish_search();
+            m_is_searching = true;
+            m_loop.spawn(search(command.text));
+            m_has_searched = true;
+        }
+        break;
+    case Command::Kind::Stop:
+        if (m_client) {
+            m_client->halt(BESTMOVE_TIMEOUT);
+        }
+        break;
+    case Command::Kind::Clear:
+        m_tree.clear();
+        clear_search_stats(m_stats);
+        break;
+    }
+    m_on_update();
+}
+
+// Ends on the bestmove, when the engine exits, or shortly after a halt.
+uci::Task<void> EngineSession::search(std::string limits) {
+    co_await m_client->go(limits, uci::UciClient::NO_TIMEOUT);
+    m_is_searching = false;
+}
+
+void EngineSession::finish_search() {
+    if (!m_is_searching) {
+        return;
+    }
+    m_client->halt(BESTMOVE_TIMEOUT);
+    while (m_is_searching) {
+        m_loop.poll();
+    }
+}
+
+void EngineSession::handle_line(const process::Line& line) {
+    auto info = uci::parse_line(line.text);
+    if (!info) {
+        return;
+    }
+    record_search_stats(m_stats, *info);
+    if (!info->pv.empty()) {
+        m_tree.update(*info);
+    }
+    m_on_update();
+}
+
+} // namespace vgce::core
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "concurrent_queue.hpp"
+#include "model/search_tree.hpp"
+#include "uci/engine_pool.hpp"
+#include "uci/event_loop.hpp"
+#include "uci/uci_data.hpp"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace vgce::core {
+
+// Stat updates shared by every engine's processing thread.
+void record_search_stats(uci::GlobalStats& stats, const uci::InfoData& info);
+void clear_search_stats(uci::GlobalStats& stats);
+
+// An engine analysing alongside the main one in comparison mode, with its
+// own pool, client, tree and stats. Commands are queued and run on the
+// session's thread between engine lines, so no engine waits on another.
+class EngineSession {
+public:
+    // on_update is called from the session thread after each tree update.
+    // memory_budget caps the session's tree as --tree-memory caps the main
+    // one; 0 leaves it unbounded.
+    EngineSession(uci::EngineConfig config, u16 spare_count, bool merge_transpositions, u64 memory_budget,
+                  std::function<void()> on_update);
+    ~EngineSession();
+
+    EngineSession(const EngineSession&) = delete;
+    EngineSession& operator=(const EngineSession&) = delete;
+
+    // Acquires the first engine and starts the thread. Throws
+    // std::runtime_error if the engine does not complete its handshake.
+    void start();
+    void stop();
+
+    // "startpos" or a FEN. A session that has searched before moves to a
+    // fresh engine from its pool, as the main engine does.
+    void set_position(const std::string& position);
+    // limits as for UciClient::go(), e.g. "infinite".
+    void go(const std::string& limits);
+    void halt();
+    void clear();
+
+    const model::SearchTree& tree() const { return m_tree; }
+    const uci::GlobalStats& stats() const { return m_stats; }
+    bool has_failed() const { return m_has_failed.load(); }
+
+private:
+    struct Command {
+        enum class Kind : u8 { Position, Go, Stop, Clear };
+
+        Kind kind;
+        std::string text;
+    };
+
+    void run();
+    void execute(const Command& command);
+    void handle_line(const process::Line& line);
+    uci::Task<void> search(std::string limits);
+    // Halts a running search and waits for it to end, so the engine can take
+    // another go or go back to the pool.
+    void finish_search();
+
+    uci::EnginePool m_pool;
+    std::unique_ptr<uci::UciClient> m_client;
+    // Watches m_client; run by the session thread. Declared after the client
+    // so it is destroyed first.
+    uci::EventLoop m_loop;
+    model::SearchTree m_tree;
+    uci::GlobalStats m_stats;
+    std::function<void()> m_on_update;
+    ConcurrentQueue<Command> m_commands;
+    std::thread m_thread;
+    std::atomic<bool> m_is_running{false};
+    std::atomic<bool> m_has_failed{false};
+    // Only touched by the session thread.
+    bool m_has_searched = false;
+    bool m_is_searching = false;
+};
+
+} // namespace vgce::core
@@ -0,0 +1,125 @@
+#include "core/game_analysis.hpp"
+#include "model/move_annotation.hpp"
+#include <cstdio>
+
+namespace vgce::core {
+
+namespace {
+
+constexpr u64 PGN_LINE_WIDTH = 79;
+
+// The inverse of the PGN reader's tag unescaping.
+std::string escape_tag_value(std::string_view value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+// White's view, as PGN readers expect.
+std::string format_eval(const PlyEval& eval, bool white_to_move) {
+    i32 value = white_to_move ? eval.score.value : -eval.score.value;
+    std::string text;
+    if (eval.score.type == uci::Score::Type::Mate) {
+        text = "#" + std::to_string(value);
+    } else {
+        char buffer[16];
+        std::snprintf(buffer, sizeof(buffer), "%+.2f", value / 100.0);
+        text = buffer;
+    }
+    return text + "/" + std::to_string(eval.depth);
+}
+
+} // namespace
+
+GameAnalysis::GameAnalysis(chess::PgnGame game) : m_game(std::move(game)) {
+    auto position = chess::Position::from_string(m_game.start);
+    m_positions.push_back(m_game.start);
+    for (chess::Move move : m_game.moves) {
+        m_white_to_move.push_back(position.side_to_move() == chess::Color::White);
+        m_fullmove.push_back(position.fullmove_number());
+        m_san_moves.push_back(position.to_san(move));
+        m_uci_moves.push_back(chess::move_to_uci(move));
+        position.make_move(move);
+        m_positions.push_back(position.to_fen());
+    }
+    m_white_to_move.push_back(position.side_to_move() == chess::Color::White);
+    m_evals.resize(m_positions.size());
+}
+
+std::string GameAnalysis::position_command(u64 ply) const {
+    std::string command = m_game.start == "startpos" ? "position startpos" : "position fen " + m_game.start;
+    if (ply > 0) {
+        command += " moves";
+        for (u64 i = 0; i < ply && i < m_uci_moves.size(); ++i) {
+            command += " " + m_uci_moves[i];
+        }
+    }
+    return command;
+}
+
+void GameAnalysis::record(u64 ply, PlyEval eval) {
+    if (ply < m_evals.size()) {
+        m_evals[ply] = std::move(eval);
+    }
+}
+
+void GameAnalysis::write_pgn(std::ostream& out) const {
+    bool has_annotator = false;
+    for (const auto& [name, value] : m_game.tags) {
+        has_annotator |= name == "Annotator";
+        out << "[" << name << " \"" << (name == "Annotator" ? "vgce" : escape_tag_value(value)) << "\"]\n";
+    }
+    if (!has_annotator) {
+        out << "[Annotator \"vgce\"]\n";
+    }
+    out << "\n";
+
+    std::string line;
+    auto emit = [&](const std::string& token) {
+        if (!line.empty() && line.size() + 1 + token.size() > PGN_LINE_WIDTH) {
+            out << line << "\n";
+            line.clear();
+        }
+        line += (line.empty() ? "" : " ") + token;
+    };
+
+    // A black move needs its number again after a comment.
+    bool needs_number = true;
+    for (u64 i = 0; i < m_san_moves.size(); ++i) {
+        if (m_white_to_move[i]) {
+            emit(std::to_string(m_fullmove[i]) + ". " + m_san_moves[i]);
+        } else {
+            emit((needs_number ? std::to_string(m_fullmove[i]) + "... " : "") + m_san_moves[i]);
+        }
+        needs_number = false;
+
+        const auto& before = m_evals[i];
+        const auto& after = m_evals[i + 1];
+        std::string_view annotation;
+        if (before && after) {
+            // The position after the move is scored for the opponent.
+            annotation = model::annotate_move(before->score.to_cp() + after->score.to_cp());
+            if (!annotation.starts_with('?')) {
+                annotation = {};
+            }
+            line += annotation;
+        }
+        if (after) {
+            std::string comment = "{" + format_eval(*after, m_white_to_move[i + 1]);
+            if (!annotation.empty() && !before->best_move.empty()) {
+                comment += " best " + before->best_move;
+            }
+            emit(comment + "}");
+            needs_number = true;
+        }
+    }
+    emit(m_game.result);
+    out << line << "\n";
+}
+
+} // namespace vgce::core
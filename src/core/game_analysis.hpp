@@ -0,0 +1,48 @@
+#pragma once
+
+#include "chess/pgn.hpp"
+#include "uci/uci_data.hpp"
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace vgce::core {
+
+// The engine's verdict on one position of a game.
+struct PlyEval {
+    // From the side to move.
+    uci::Score score{};
+    u16 depth = 0;
+    // SAN.
+    std::string best_move;
+};
+
+// Walks a PGN game ply by ply. Positions are sent as the start position plus
+// the moves so far, so the engine keeps its hash between plies, and each
+// move is annotated from the evals before and after it.
+class GameAnalysis {
+public:
+    explicit GameAnalysis(chess::PgnGame game);
+
+    // One per ply, from the start through the position after the last move,
+    // as stored in AppConfig::positions.
+    const std::vector<std::string>& positions() const { return m_positions; }
+    std::string position_command(u64 ply) const;
+
+    void record(u64 ply, PlyEval eval);
+    // The game with ?!, ? and ?? on moves that lose ground, an eval comment
+    // after each analysed move and the engine's choice after annotated ones.
+    void write_pgn(std::ostream& out) const;
+
+private:
+    chess::PgnGame m_game;
+    std::vector<std::string> m_positions;
+    std::vector<std::string> m_uci_moves;
+    std::vector<std::string> m_san_moves;
+    std::vector<bool> m_white_to_move;
+    std::vector<u16> m_fullmove;
+    std::vector<std::optional<PlyEval>> m_evals;
+};
+
+} // namespace vgce::core
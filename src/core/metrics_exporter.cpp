@@ -0,0 +1,220 @@
+#include "core/metrics_exporter.hpp"
+#include "metrics/trace.hpp"
+#include <array>
+#include <fstream>
+#include <sstream>
+
+namespace vgce::core {
+
+namespace {
+
+// Scrapes are rare, so pending connections are picked up at this pace.
+constexpr auto ACCEPT_INTERVAL = std::chrono::milliseconds(100);
+constexpr auto REQUEST_TIMEOUT = std::chrono::seconds(1);
+constexpr u64 MAX_REQUEST_BYTES = 8 * 1024;
+
+std::string escape_label(std::string_view value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+        } else if (c == '\n') {
+            escaped += "\\n";
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+void write_metric(std::ostream& out, std::string_view name, std::string_view type, std::string_view help,
+                  u64 value) {
+    out << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n"
+        << name << " " << value << "\n";
+}
+
+void write_signed(std::ostream& out, std::string_view name, std::string_view help, i64 value) {
+    out << "# HELP " << name << " " << help << "\n# TYPE " << name << " gauge\n" << name << " " << value << "\n";
+}
+
+std::string to_seconds(u64 ns) {
+    std::ostringstream text;
+    text << static_cast<f64>(ns) / 1e9;
+    return text.str();
+}
+
+} // namespace
+
+MetricsExporter::MetricsExporter(MetricsSources sources, std::optional<u16> port, std::filesystem::path file,
+                                 std::chrono::milliseconds file_interval)
+        : m_sources(std::move(sources)), m_file(std::move(file)), m_file_interval(file_interval) {
+    if (port) {
+        m_listener = process::LocalSocket::listen_loopback(*port);
+    }
+    m_thread = std::thread(&MetricsExporter::run, this);
+}
+
+MetricsExporter::~MetricsExporter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_is_running = false;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+std::string MetricsExporter::collect() const {
+    const auto& stats = m_sources.stats;
+    const auto& counters = m_sources.counters;
+    std::ostringstream out;
+
+    out << "# HELP vgce_engine_info The engine being analysed.\n# TYPE vgce_engine_info gauge\n"
+        << "vgce_engine_info{engine=\"" << escape_label(m_sources.engine_name) << "\"} 1\n";
+    write_metric(out, "vgce_engine_nodes", "gauge", "Nodes searched in the current search.",
+                 stats.nodes.load(std::memory_order_relaxed));
+    write_metric(out, "vgce_engine_nps", "gauge", "Nodes per second the engine reports.",
+                 stats.nps.load(std::memory_order_relaxed));
+    write_metric(out, "vgce_engine_hashfull_permille", "gauge", "Hash table fill, per mille.",
+                 stats.hashfull.load(std::memory_order_relaxed));
+    write_metric(out, "vgce_engine_tbhits", "gauge", "Tablebase hits in the current search.",
+                 stats.tbhits.load(std::memory_order_relaxed));
+    write_metric(out, "vgce_engine_depth", "gauge", "Depth of the main line.",
+                 stats.main_depth.load(std::memory_order_relaxed));
+    write_metric(out, "vgce_engine_search_time_ms", "gauge", "Engine time in the current search.",
+                 stats.time_ms.load(std::memory_order_relaxed));
+    write_signed(out, "vgce_engine_score_cp", "Main line score for the side to move; mates read as +-10000.",
+                 stats.main_score_cp.load(std::memory_order_relaxed));
+    write_signed(out, "vgce_engine_mate_moves", "Signed moves to mate on the main line, 0 without a mate.",
+                 stats.main_mate.load(std::memory_order_relaxed));
+    write_metric(out, "vgce_engine_cpu_permille", "gauge", "Engine CPU use, per mille of one core.",
+                 stats.engine_cpu_permille.load(std::memory_order_relaxed));
+    write_metric(out, "vgce_engine_rss_bytes", "gauge", "Engine resident memory.",
+                 stats.engine_rss_bytes.load(std::memory_order_relaxed));
+    write_metric(out, "vgce_viewer_cpu_permille", "gauge", "vgce CPU use, per mille of one core.",
+                 stats.viewer_cpu_permille.load(std::memory_order_relaxed));
+    write_metric(out, "vgce_viewer_rss_bytes", "gauge", "vgce resident memory.",
+                 stats.viewer_rss_bytes.load(std::memory_order_relaxed));
+
+    write_metric(out, "vgce_infos_parsed_total", "counter", "Engine info lines parsed.",
+                 counters.infos_parsed.load(std::memory_order_relaxed));
+    write_metric(out, "vgce_tree_updates_total", "counter", "Info lines applied to the tree.",
+                 counters.tree_updates.load(std::memory_order_relaxed));
+    write_metric(out, "vgce_frames_requested_total", "counter", "Frames requested by updates.",
+                 counters.frames_requested.load(std::memory_order_relaxed));
+    write_metric(out, "vgce_frames_rendered_total", "counter", "Frames drawn.",
+                 counters.frames_rendered.load(std::memory_order_relaxed));
+
+    auto queue = m_sources.queue_stats ? m_sources.queue_stats() : metrics::QueueStats{};
+    write_metric(out, "vgce_queue_depth", "gauge", "Engine lines read but not yet processed.", queue.depth);
+    write_metric(out, "vgce_queue_high_water", "gauge", "Deepest the engine line queue has been.",
+                 queue.high_water);
+    write_metric(out, "vgce_queue_pushed_total", "counter", "Engine lines read.", queue.total_pushed);
+
+    out << "# HELP vgce_pipeline_latency_seconds Latency of each stage from engine output to screen.\n"
+        << "# TYPE vgce_pipeline_latency_seconds summary\n";
+    const auto& latency = m_sources.latency;
+    const std::array<std::pair<const char*, const metrics::LatencyHistogram*>, 7> stages = {{
+        {"read_to_parse", &latency.read_to_parse},
+        {"parse_to_tree", &latency.parse_to_tree},
+        {"tree_to_frame", &latency.tree_to_frame},
+        {"read_to_frame", &latency.read_to_frame},
+        {"frame_time", &m_sources.counters.frame_time},
+        {"gui_to_engine", &latency.gui_to_engine},
+        {"engine_to_gui", &latency.engine_to_gui},
+    }};
+    for (const auto& [stage, histogram] : stages) {
+        for (f64 quantile : {0.5, 0.9, 0.99}) {
+            out << "vgce_pipeline_latency_seconds{stage=\"" << stage << "\",quantile=\"" << quantile << "\"} "
+                << to_seconds(histogram->percentile(quantile)) << "\n";
+        }
+        out << "vgce_pipeline_latency_seconds_sum{stage=\"" << stage << "\"} " << to_seconds(histogram->sum())
+            << "\n"
+            << "vgce_pipeline_latency_seconds_count{stage=\"" << stage << "\"} " << histogram->count() << "\n";
+    }
+    return out.str();
+}
+
+void MetricsExporter::run() {
+    VGCE_TRACE_THREAD("metrics");
+    auto next_write = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_is_running) {
+        lock.unlock();
+        if (m_listener.is_open()) {
+            while (auto peer = m_listener.accept()) {
+                serve(*peer);
+            }
+        }
+        if (!m_file.empty() && std::chrono::steady_clock::now() >= next_write) {
+            write_file();
+            next_write = std::chrono::steady_clock::now() + m_file_interval;
+        }
+        lock.lock();
+        m_cv.wait_for(lock, ACCEPT_INTERVAL, [this] { return !m_is_running; });
+    }
+}
+
+// Just enough HTTP/1.1 for a scraper: one GET per connection, then close.
+void MetricsExporter::serve(process::LocalSocket& peer) {
+    std::string request;
+    std::array<u8, 1024> buffer{};
+    auto deadline = std::chrono::steady_clock::now() + REQUEST_TIMEOUT;
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_BYTES) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline -
+                                                                               std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            return;
+        }
+        i64 received = peer.receive(buffer, remaining);
+        if (received < 0) {
+            return;
+        }
+        request.append(reinterpret_cast<const char*>(buffer.data()), static_cast<u64>(received));
+    }
+
+    std::string status = "200 OK";
+    std::string body;
+    if (request.starts_with("GET /metrics ") || request.starts_with("GET / ")) {
+        VGCE_TRACE_SCOPE("metrics.collect");
+        body = collect();
+    } else {
+        status = "404 Not Found";
+    }
+    std::string response = "HTTP/1.1 " + status +
+                           "\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                           std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+
+    std::span<const u8> pending(reinterpret_cast<const u8*>(response.data()), response.size());
+    deadline = std::chrono::steady_clock::now() + REQUEST_TIMEOUT;
+    while (!pending.empty() && std::chrono::steady_clock::now() < deadline) {
+        i64 sent = peer.send_some(pending);
+        if (sent < 0) {
+            return;
+        }
+        if (sent == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        pending = pending.subspan(static_cast<u64>(sent));
+    }
+}
+
+// The collector must never see a half-written file, so the text goes to a
+// temporary name first and replaces the file in one rename.
+void MetricsExporter::write_file() {
+    VGCE_TRACE_SCOPE("metrics.write");
+    auto temporary = m_file;
+    temporary += ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::out | std::ios::trunc);
+        out << collect();
+        if (!out.good()) {
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, m_file, error);
+}
+
+} // namespace vgce::core
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "metrics/latency_histogram.hpp"
+#include "metrics/pipeline_counters.hpp"
+#include "process/local_socket.hpp"
+#include "uci/uci_data.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace vgce::core {
+
+// What the exporter reads. Everything is an atomic or a lock-free view, so
+// collecting never takes the tree lock or waits on the processing thread.
+struct MetricsSources {
+    std::string engine_name;
+    const uci::GlobalStats& stats;
+    const metrics::PipelineCounters& counters;
+    const metrics::PipelineLatency& latency;
+    std::function<metrics::QueueStats()> queue_stats;
+};
+
+// Exposes the stats in the Prometheus text format on its own thread, served
+// at http://127.0.0.1:<port>/metrics, written to a textfile-collector file
+// (replaced atomically at each interval), or both.
+class MetricsExporter {
+public:
+    // Throws std::runtime_error if the port cannot be listened on.
+    MetricsExporter(MetricsSources sources, std::optional<u16> port, std::filesystem::path file,
+                    std::chrono::milliseconds file_interval);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    std::string collect() const;
+
+private:
+    void run();
+    void serve(process::LocalSocket& peer);
+    void write_file();
+
+    MetricsSources m_sources;
+    process::LocalSocket m_listener;
+    std::filesystem::path m_file;
+    std::chrono::milliseconds m_file_interval;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_is_running = true;
+    std::thread m_thread;
+};
+
+} // namespace vgce::core
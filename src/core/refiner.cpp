@@ -0,0 +1,125 @@
+#include "core/refiner.hpp"
+#include "metrics/trace.hpp"
+#include "uci/event_loop.hpp"
+#include "uci/uci_parser.hpp"
+
+namespace vgce::core {
+
+namespace {
+
+constexpr auto ACQUIRE_TIMEOUT = std::chrono::seconds(30);
+constexpr auto BESTMOVE_TIMEOUT = std::chrono::seconds(5);
+
+uci::Task<void> search(uci::UciClient& client, std::string limits) {
+    co_await client.go(limits, uci::UciClient::NO_TIMEOUT);
+}
+
+} // namespace
+
+// No spares are kept launched: refinements are occasional, and the pool
+// still keeps a recycled engine for the next one.
+Refiner::Refiner(uci::EngineConfig config, u16 engine_count, u16 depth, model::SearchTree& tree,
+                 std::function<void()> on_update)
+        : m_pool(std::move(config), 0), m_engine_count(engine_count), m_depth(depth), m_tree(tree),
+          m_on_update(std::move(on_update)) {
+}
+
+Refiner::~Refiner() {
+    cancel_all();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& job : m_jobs) {
+        if (job->thread.joinable()) {
+            job->thread.join();
+        }
+    }
+    m_jobs.clear();
+    m_pool.shutdown();
+}
+
+bool Refiner::refine(std::vector<std::string> path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    reap();
+    if (m_jobs.size() >= m_engine_count) {
+        return false;
+    }
+    auto job = std::make_unique<Job>();
+    job->thread = std::thread(&Refiner::run, this, std::ref(*job), m_tree.get_root_position(), std::move(path));
+    m_jobs.push_back(std::move(job));
+    return true;
+}
+
+void Refiner::cancel_all() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& job : m_jobs) {
+        job->is_cancelled.store(true);
+    }
+}
+
+u16 Refiner::active_count() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    u16 count = 0;
+    for (const auto& job : m_jobs) {
+        count += job->is_done.load() ? 0 : 1;
+    }
+    return count;
+}
+
+void Refiner::reap() {
+    std::erase_if(m_jobs, [](std::unique_ptr<Job>& job) {
+        if (!job->is_done.load()) {
+            return false;
+        }
+        job->thread.join();
+        return true;
+    });
+}
+
+void Refiner::run(Job& job, chess::Position root, std::vector<std::string> path) {
+    VGCE_TRACE_THREAD("refine");
+    std::unique_ptr<uci::UciClient> client;
+    try {
+        client = m_pool.acquire(ACQUIRE_TIMEOUT);
+    } catch (const std::exception&) {
+        client = nullptr;
+    }
+    if (!client) {
+        job.is_done.store(true);
+        return;
+    }
+
+    std::string command = "position fen " + root.to_fen();
+    if (!path.empty()) {
+        command += " moves";
+        for (const auto& move : path) {
+            command += " " + move;
+        }
+    }
+    client->send_command(command);
+
+    uci::EventLoop loop;
+    loop.watch(*client, [&](const process::Line& line) {
+        auto info = uci::parse_line(line.text);
+        if (info && !info->pv.empty()) {
+            info->read_ns = line.read_ns;
+            m_tree.graft(root.key(), path, *info);
+            m_on_update();
+        }
+    });
+    // The search ends on its bestmove, when the engine exits, or shortly
+    // after a cancel halts it.
+    auto task = search(*client, "depth " + std::to_string(m_depth));
+    task.start();
+    bool is_halted = false;
+    while (!task.is_done()) {
+        if (!is_halted && job.is_cancelled.load()) {
+            client->halt(BESTMOVE_TIMEOUT);
+            is_halted = true;
+        }
+        loop.poll();
+    }
+    loop.unwatch(*client);
+    m_pool.release(std::move(client));
+    job.is_done.store(true);
+}
+
+} // namespace vgce::core
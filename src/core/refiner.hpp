@@ -0,0 +1,55 @@
+#pragma once
+
+#include "model/search_tree.hpp"
+#include "uci/engine_pool.hpp"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vgce::core {
+
+// Searches positions picked in the tree view on engines from a separate
+// small pool and grafts the lines under the picked node, so the main search
+// keeps running untouched.
+class Refiner {
+public:
+    // on_update is called from search threads after each graft.
+    Refiner(uci::EngineConfig config, u16 engine_count, u16 depth, model::SearchTree& tree,
+            std::function<void()> on_update);
+    ~Refiner();
+
+    Refiner(const Refiner&) = delete;
+    Refiner& operator=(const Refiner&) = delete;
+
+    // path is UCI moves from the tree's current root. Returns false when
+    // every engine is busy.
+    bool refine(std::vector<std::string> path);
+    // Stops every search, e.g. when the root changes.
+    void cancel_all();
+    u16 active_count() const;
+
+private:
+    struct Job {
+        std::thread thread;
+        std::atomic<bool> is_cancelled{false};
+        std::atomic<bool> is_done{false};
+    };
+
+    void run(Job& job, chess::Position root, std::vector<std::string> path);
+    // Joins finished jobs; called with m_mutex held.
+    void reap();
+
+    uci::EnginePool m_pool;
+    u16 m_engine_count;
+    u16 m_depth;
+    model::SearchTree& m_tree;
+    std::function<void()> m_on_update;
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Job>> m_jobs;
+};
+
+} // namespace vgce::core
@@ -0,0 +1,147 @@
+#include "core/resource_sampler.hpp"
+#include "process/placement.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace vgce::core {
+
+namespace {
+
+// Nice value for the sampler thread, so it yields to the engine and the UI.
+constexpr i32 SAMPLER_NICE = 10;
+
+u32 to_permille(u64 delta_ns, u64 wall_ns) {
+    return wall_ns > 0 ? static_cast<u32>(delta_ns * 1000 / wall_ns) : 0;
+}
+
+u32 to_rate(u64 delta, u64 wall_ns) {
+    return wall_ns > 0 ? static_cast<u32>(delta * 1'000'000'000ULL / wall_ns) : 0;
+}
+
+u64 elapsed_ns(std::chrono::steady_clock::time_point from,
+               std::chrono::steady_clock::time_point to) {
+    return static_cast<u64>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+u64 counter_delta(u64 now, u64 before) {
+    return now > before ? now - before : 0;
+}
+
+} // namespace
+
+ResourceSampler::ResourceSampler(uci::GlobalStats& stats) : m_global_stats(stats) {
+    m_global_stats.cpu_count.store(process::online_cpu_count());
+}
+
+ResourceSampler::~ResourceSampler() {
+    stop();
+}
+
+void ResourceSampler::start(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_is_running) {
+        return;
+    }
+    m_interval = interval;
+    m_is_running = true;
+    m_thread = std::thread(&ResourceSampler::sampler_loop, this);
+}
+
+void ResourceSampler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_is_running = false;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void ResourceSampler::set_engine_pid(i64 pid) {
+    m_engine_pid.store(pid);
+}
+
+void ResourceSampler::sampler_loop() {
+    process::Placement low_priority;
+    low_priority.nice = SAMPLER_NICE;
+    process::apply_to_current_thread(low_priority);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_is_running) {
+        lock.unlock();
+        sample_engine();
+        sample_viewer();
+        lock.lock();
+        m_cv.wait_for(lock, m_interval, [this] { return !m_is_running; });
+    }
+}
+
+void ResourceSampler::sample_engine() {
+    i64 pid = m_engine_pid.load();
+    if (pid <= 0) {
+        return;
+    }
+    auto usage = process::read_resource_usage(pid);
+    if (!usage) {
+        return;
+    }
+    Sample sample{pid, std::chrono::steady_clock::now(), std::move(*usage)};
+
+    m_global_stats.engine_rss_bytes.store(sample.usage.rss_bytes);
+    m_global_stats.engine_threads.store(static_cast<u32>(sample.usage.threads.size()));
+
+    if (m_last_engine && m_last_engine->pid == pid) {
+        const auto& last = m_last_engine->usage;
+        u64 wall_ns = elapsed_ns(m_last_engine->time, sample.time);
+
+        m_global_stats.engine_cpu_permille.store(
+            to_permille(counter_delta(sample.usage.cpu_time_ns, last.cpu_time_ns), wall_ns));
+        m_global_stats.engine_voluntary_switches_per_sec.store(to_rate(
+            counter_delta(sample.usage.voluntary_switches, last.voluntary_switches), wall_ns));
+        m_global_stats.engine_involuntary_switches_per_sec.store(to_rate(
+            counter_delta(sample.usage.involuntary_switches, last.involuntary_switches),
+            wall_ns));
+        m_global_stats.engine_run_delay_permille.store(
+            to_permille(counter_delta(sample.usage.run_delay_ns, last.run_delay_ns), wall_ns));
+
+        // Attribute each thread's CPU time to the core it last ran on.
+        std::unordered_map<i64, u64> previous;
+        for (const auto& thread : last.threads) {
+            previous[thread.tid] = thread.cpu_time_ns;
+        }
+        u32 cpu_count = std::min(m_global_stats.cpu_count.load(), uci::MAX_TRACKED_CPUS);
+        std::vector<u64> core_ns(cpu_count, 0);
+        for (const auto& thread : sample.usage.threads) {
+            auto it = previous.find(thread.tid);
+            if (it != previous.end() && thread.processor < cpu_count) {
+                core_ns[thread.processor] += counter_delta(thread.cpu_time_ns, it->second);
+            }
+        }
+        for (u32 cpu = 0; cpu < cpu_count; ++cpu) {
+            u32 load = std::min<u32>(to_permille(core_ns[cpu], wall_ns), 1000);
+            m_global_stats.engine_core_permille[cpu].store(static_cast<u16>(load));
+        }
+    }
+    m_last_engine = std::move(sample);
+}
+
+void ResourceSampler::sample_viewer() {
+    i64 pid = process::current_process_id();
+    auto usage = process::read_resource_usage(pid);
+    if (!usage) {
+        return;
+    }
+    Sample sample{pid, std::chrono::steady_clock::now(), std::move(*usage)};
+
+    m_global_stats.viewer_rss_bytes.store(sample.usage.rss_bytes);
+    if (m_last_viewer) {
+        u64 wall_ns = elapsed_ns(m_last_viewer->time, sample.time);
+        m_global_stats.viewer_cpu_permille.store(to_permille(
+            counter_delta(sample.usage.cpu_time_ns, m_last_viewer->usage.cpu_time_ns), wall_ns));
+    }
+    m_last_viewer = std::move(sample);
+}
+
+} // namespace vgce::core
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "process/resource_usage.hpp"
+#include "uci/uci_data.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace vgce::core {
+
+// Periodically samples the engine's and vgce's own resource usage into
+// GlobalStats on a low-priority background thread.
+class ResourceSampler {
+public:
+    explicit ResourceSampler(uci::GlobalStats& stats);
+    ~ResourceSampler();
+
+    ResourceSampler(const ResourceSampler&) = delete;
+    ResourceSampler& operator=(const ResourceSampler&) = delete;
+
+    void start(std::chrono::milliseconds interval);
+    void stop();
+    void set_engine_pid(i64 pid);
+
+private:
+    struct Sample {
+        i64 pid = 0;
+        std::chrono::steady_clock::time_point time;
+        process::ResourceUsage usage;
+    };
+
+    void sampler_loop();
+    void sample_engine();
+    void sample_viewer();
+
+    uci::GlobalStats& m_global_stats;
+    std::chrono::milliseconds m_interval{1000};
+    std::atomic<i64> m_engine_pid{0};
+    std::optional<Sample> m_last_engine;
+    std::optional<Sample> m_last_viewer;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_is_running = false;
+    std::thread m_thread;
+};
+
+} // namespace vgce::core
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "types.hpp"
+#include <chrono>
+
+namespace vgce::metrics {
+
+// Monotonic timestamp shared by every pipeline stage so that stamps taken on
+// different threads can be subtracted.
+inline u64 monotonic_ns() {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count());
+}
+
+} // namespace vgce::metrics
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "metrics/clock.hpp"
+#include "types.hpp"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <ostream>
+#include <string>
+
+namespace vgce::metrics {
+
+// HDR-style log-linear histogram of nanosecond latencies. Each power-of-two
+// range is split into 2^SUB_BUCKET_BITS linear buckets, giving ~3% relative
+// precision from 1ns up to hours in a fixed 15 KB table. Recording is a
+// single relaxed increment, so it is safe from any thread without locks.
+class LatencyHistogram {
+public:
+    static constexpr u32 SUB_BUCKET_BITS = 5;
+    static constexpr u64 SUB_BUCKETS = 1ULL << SUB_BUCKET_BITS;
+    static constexpr u64 BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    void record(u64 value_ns) {
+        m_buckets[bucket_index(value_ns)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value_ns, std::memory_order_relaxed);
+        u64 current_max = m_max.load(std::memory_order_relaxed);
+        while (value_ns > current_max &&
+               !m_max.compare_exchange_weak(current_max, value_ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    u64 count() const { return m_count.load(std::memory_order_relaxed); }
+    u64 max() const { return m_max.load(std::memory_order_relaxed); }
+    u64 sum() const { return m_sum.load(std::memory_order_relaxed); }
+
+    u64 mean() const {
+        u64 samples = count();
+        return samples > 0 ? m_sum.load(std::memory_order_relaxed) / samples : 0;
+    }
+
+    // Value at quantile q in [0, 1], reported as the midpoint of its bucket.
+    u64 percentile(f64 q) const {
+        u64 samples = count();
+        if (samples == 0) {
+            return 0;
+        }
+        u64 target = static_cast<u64>(q * static_cast<f64>(samples - 1)) + 1;
+        u64 seen = 0;
+        for (u64 i = 0; i < BUCKET_COUNT; ++i) {
+            seen += m_buckets[i].load(std::memory_order_relaxed);
+            if (seen >= target) {
+                u64 value = bucket_midpoint(i);
+                return value < max() ? value : max();
+            }
+        }
+        return max();
+    }
+
+    void reset() {
+        for (auto& bucket : m_buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        m_count.store(0, std::memory_order_relaxed);
+        m_sum.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static u64 bucket_index(u64 value) {
+        if (value < SUB_BUCKETS) {
+            return value;
+        }
+        u32 msb = 63 - static_cast<u32>(std::countl_zero(value));
+        u32 shift = msb - SUB_BUCKET_BITS;
+        u64 sub = (value >> shift) & (SUB_BUCKETS - 1);
+        return (shift + 1) * SUB_BUCKETS + sub;
+    }
+
+    static u64 bucket_midpoint(u64 index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        u64 shift = index / SUB_BUCKETS - 1;
+        u64 sub = index % SUB_BUCKETS;
+        u64 lower = (SUB_BUCKETS + sub) << shift;
+        return lower + ((1ULL << shift) >> 1);
+    }
+
+    std::array<std::atomic<u64>, BUCKET_COUNT> m_buckets{};
+    std::atomic<u64> m_count{0};
+    std::atomic<u64> m_sum{0};
+    std::atomic<u64> m_max{0};
+};
+
+// Latency of each stage between the engine writing a line and a frame
+// showing its effect.
+struct PipelineLatency {
+    LatencyHistogram read_to_parse;
+    LatencyHistogram parse_to_tree;
+    LatencyHistogram tree_to_frame;
+    LatencyHistogram read_to_frame;
+    // With --proxy, from vgce waking on input to passing it on.
+    LatencyHistogram gui_to_engine;
+    LatencyHistogram engine_to_gui;
+};
+
+inline std::string format_duration(u64 ns) {
+    if (ns >= 1'000'000'000) {
+        return std::to_string(ns / 1'000'000'000) + "." +
+               std::to_string((ns / 100'000'000) % 10) + "s";
+    } else if (ns >= 1'000'000) {
+        return std::to_string(ns / 1'000'000) + "." + std::to_string((ns / 100'000) % 10) + "ms";
+    } else if (ns >= 1'000) {
+        return std::to_string(ns / 1'000) + "." + std::to_string((ns / 100) % 10) + "us";
+    }
+    return std::to_string(ns) + "ns";
+}
+
+inline void write_report(std::ostream& out, const PipelineLatency& latency) {
+    auto write_row = [&out](const char* stage, const LatencyHistogram& histogram) {
+        out << stage << "  count=" << histogram.count()
+            << " mean=" << format_duration(histogram.mean())
+            << " p50=" << format_duration(histogram.percentile(0.50))
+            << " p90=" << format_duration(histogram.percentile(0.90))
+            << " p99=" << format_duration(histogram.percentile(0.99))
+            << " p99.9=" << format_duration(histogram.percentile(0.999))
+            << " max=" << format_duration(histogram.max()) << "\n";
+    };
+    out << "VGCE Pipeline Latency\n";
+    out << "=====================\n";
+    write_row("read->parse ", latency.read_to_parse);
+    write_row("parse->tree ", latency.parse_to_tree);
+    write_row("tree->frame ", latency.tree_to_frame);
+    write_row("read->frame ", latency.read_to_frame);
+    if (latency.gui_to_engine.count() > 0 || latency.engine_to_gui.count() > 0) {
+        write_row("gui->engine ", latency.gui_to_engine);
+        write_row("engine->gui ", latency.engine_to_gui);
+    }
+}
+
+} // namespace vgce::metrics
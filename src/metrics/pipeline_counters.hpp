@@ -0,0 +1,34 @@
+#pragma once
+
+#include "metrics/latency_histogram.hpp"
+#include "types.hpp"
+#include <atomic>
+
+namespace vgce::metrics {
+
+// Each counter has exactly one writing thread, so increments are a relaxed
+// load and store rather than a locked read-modify-write.
+inline void bump(std::atomic<u64>& counter, u64 amount = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+struct PipelineCounters {
+    // Processing thread.
+    std::atomic<u64> infos_parsed{0};
+    std::atomic<u64> tree_updates{0};
+    std::atomic<u64> frames_requested{0};
+
+    // Render thread.
+    std::atomic<u64> frames_rendered{0};
+    std::atomic<u64> last_frame_ns{0};
+    LatencyHistogram frame_time;
+};
+
+// Lock-free view of the engine output queue.
+struct QueueStats {
+    u64 depth = 0;
+    u64 high_water = 0;
+    u64 total_pushed = 0;
+};
+
+} // namespace vgce::metrics
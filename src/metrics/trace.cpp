@@ -0,0 +1,138 @@
+#include "metrics/trace.hpp"
+
+#ifdef VGCE_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vgce::metrics::trace {
+
+namespace {
+
+struct Event {
+    const char* name;
+    u64 start_ns;
+    u64 end_ns;
+};
+
+// A ring slot is a small seqlock: sequence is the slot's event index plus
+// one once written, and 0 while the owning thread rewrites it, so dump()
+// can tell a torn or lapped slot from a finished one.
+struct Slot {
+    std::atomic<u64> sequence{0};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<u64> start_ns{0};
+    std::atomic<u64> end_ns{0};
+};
+
+// Written only by its owning thread; dump() reads up to the published head.
+struct ThreadBuffer {
+    u32 tid = 0;
+    std::string name;
+    std::unique_ptr<Slot[]> slots = std::make_unique<Slot[]>(RING_CAPACITY);
+    std::atomic<u64> head{0};
+};
+
+// Copies the events still in the ring, skipping any the owning thread
+// overwrote while they were read.
+std::vector<Event> snapshot(const ThreadBuffer& buffer) {
+    std::vector<Event> events;
+    u64 head = buffer.head.load(std::memory_order_acquire);
+    u64 begin = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+    events.reserve(head - begin);
+    for (u64 i = begin; i < head; ++i) {
+        const Slot& slot = buffer.slots[i & (RING_CAPACITY - 1)];
+        u64 before = slot.sequence.load(std::memory_order_acquire);
+        Event event{slot.name.load(std::memory_order_relaxed), slot.start_ns.load(std::memory_order_relaxed),
+                    slot.end_ns.load(std::memory_order_relaxed)};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (before == i + 1 && slot.sequence.load(std::memory_order_relaxed) == before) {
+            events.push_back(event);
+        }
+    }
+    return events;
+}
+
+std::mutex g_registry_mutex;
+// Buffers outlive their threads so spans of finished threads still get dumped.
+std::vector<std::shared_ptr<ThreadBuffer>> g_buffers;
+const auto g_epoch = std::chrono::steady_clock::now();
+
+ThreadBuffer& local_buffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+        auto created = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        created->tid = static_cast<u32>(g_buffers.size() + 1);
+        created->name = "thread-" + std::to_string(created->tid);
+        g_buffers.push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+
+void write_us(std::ofstream& out, u64 ns) {
+    out << ns / 1000 << "." << (ns % 1000) / 100 << (ns % 100) / 10 << ns % 10;
+}
+
+} // namespace
+
+u64 now_ns() {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now() - g_epoch)
+                                .count());
+}
+
+void record(const char* name, u64 start_ns, u64 end_ns) {
+    auto& buffer = local_buffer();
+    u64 head = buffer.head.load(std::memory_order_relaxed);
+    Slot& slot = buffer.slots[head & (RING_CAPACITY - 1)];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.end_ns.store(end_ns, std::memory_order_relaxed);
+    slot.sequence.store(head + 1, std::memory_order_release);
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void set_thread_name(const char* name) {
+    auto& buffer = local_buffer();
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    buffer.name = name;
+}
+
+bool dump(const std::filesystem::path& path) {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& buffer : g_buffers) {
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << buffer->tid << ",\"args\":{\"name\":\"" << buffer->name << "\"}}";
+        first = false;
+
+        for (const Event& event : snapshot(*buffer)) {
+            out << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                << buffer->tid << ",\"ts\":";
+            write_us(out, event.start_ns);
+            out << ",\"dur\":";
+            write_us(out, event.end_ns - event.start_ns);
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    return out.good();
+}
+
+} // namespace vgce::metrics::trace
+
+#endif
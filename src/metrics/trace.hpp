@@ -0,0 +1,55 @@
+#pragma once
+
+#include "types.hpp"
+#include <filesystem>
+
+// Span tracing for the engine-output pipeline. Build with -DVGCE_ENABLE_TRACING=ON
+// to record spans into per-thread ring buffers; otherwise every macro expands
+// to nothing and dump() is a no-op.
+//
+//   VGCE_TRACE_SCOPE("parse");   // records a complete ("X") event for the scope
+
+namespace vgce::metrics::trace {
+
+#ifdef VGCE_TRACING
+
+constexpr u64 RING_CAPACITY = 1 << 16;
+
+u64 now_ns();
+void record(const char* name, u64 start_ns, u64 end_ns);
+void set_thread_name(const char* name);
+
+class Scope {
+public:
+    explicit Scope(const char* name) : m_name(name), m_start_ns(now_ns()) {}
+    ~Scope() { record(m_name, m_start_ns, now_ns()); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* m_name;
+    u64 m_start_ns;
+};
+
+// Writes all buffered spans as Chrome/Perfetto trace-event JSON.
+bool dump(const std::filesystem::path& path);
+constexpr bool enabled() { return true; }
+
+#define VGCE_TRACE_CONCAT_INNER(a, b) a##b
+#define VGCE_TRACE_CONCAT(a, b) VGCE_TRACE_CONCAT_INNER(a, b)
+#define VGCE_TRACE_SCOPE(name)                                                                   \
+    ::vgce::metrics::trace::Scope VGCE_TRACE_CONCAT(vgce_trace_scope_, __LINE__)(name)
+#define VGCE_TRACE_THREAD(name) ::vgce::metrics::trace::set_thread_name(name)
+
+#else
+
+inline bool dump(const std::filesystem::path&) { return false; }
+constexpr bool enabled() { return false; }
+
+#define VGCE_TRACE_SCOPE(name) ((void)0)
+#define VGCE_TRACE_THREAD(name) ((void)0)
+
+#endif
+
+} // namespace vgce::metrics::trace
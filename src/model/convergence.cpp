@@ -0,0 +1,62 @@
+#include "model/convergence.hpp"
+#include <cstdlib>
+
+namespace vgce::model {
+
+namespace {
+
+bool within(u32 a, u32 b, u32 window) {
+    return (a > b ? a - b : b - a) <= window;
+}
+
+} // namespace
+
+ConvergenceDetector::ConvergenceDetector(const StopRule& rule) : m_rule(rule) {
+}
+
+void ConvergenceDetector::reset() {
+    m_last_depth = 0;
+    m_run = 0;
+    m_fired = false;
+    m_anchor_move.clear();
+    m_anchor_wdl.reset();
+}
+
+bool ConvergenceDetector::observe(const uci::InfoData& data) {
+    if (!m_rule.enabled() || m_fired || data.pv.empty() || !data.depth || !data.score ||
+        data.score->bound != uci::Score::Bound::Exact || *data.depth <= m_last_depth) {
+        return false;
+    }
+    m_last_depth = *data.depth;
+
+    // Mates read as a fixed score, so a mate that moves by a few plies
+    // still reads as settled.
+    i32 score = data.score->to_cp();
+    if (m_run > 0 && agrees_with_anchor(data.pv.front(), score, data.wdl)) {
+        m_run++;
+    } else {
+        m_run = 1;
+        m_anchor_move = data.pv.front();
+        m_anchor_score = score;
+        m_anchor_wdl = data.wdl;
+    }
+
+    m_fired = m_run >= m_rule.stable_depths && m_last_depth >= m_rule.min_depth;
+    return m_fired;
+}
+
+bool ConvergenceDetector::agrees_with_anchor(const std::string& best_move, i32 score_cp,
+                                             const std::optional<uci::WDL>& wdl) const {
+    if (best_move != m_anchor_move) {
+        return false;
+    }
+    if (std::abs(score_cp - m_anchor_score) <= m_rule.score_window_cp) {
+        return true;
+    }
+    return m_rule.wdl_window > 0 && wdl && m_anchor_wdl &&
+           within(wdl->win, m_anchor_wdl->win, m_rule.wdl_window) &&
+           within(wdl->draw, m_anchor_wdl->draw, m_rule.wdl_window) &&
+           within(wdl->loss, m_anchor_wdl->loss, m_rule.wdl_window);
+}
+
+} // namespace vgce::model
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "uci/uci_data.hpp"
+#include <optional>
+#include <string>
+
+namespace vgce::model {
+
+// When a search counts as settled. Disabled while stable_depths is zero.
+struct StopRule {
+    // Consecutive completed depths that must agree.
+    u16 stable_depths = 0;
+    // Scores must stay within this many centipawns of the first depth of the run.
+    i32 score_window_cp = 10;
+    // Also accepts a run whose win, draw and loss stay within this many per
+    // mille when the score moves more; zero ignores WDL.
+    u16 wdl_window = 0;
+    // Never stops before this depth.
+    u16 min_depth = 0;
+
+    bool enabled() const { return stable_depths > 0; }
+};
+
+// Follows the main line depth by depth and reports when it has settled.
+class ConvergenceDetector {
+public:
+    explicit ConvergenceDetector(const StopRule& rule = {});
+
+    void reset();
+    // Feeds a main-line info line. Only exact scores at a new depth count.
+    // Returns true once, at the depth where the rule is first met.
+    bool observe(const uci::InfoData& data);
+
+    bool has_fired() const { return m_fired; }
+    u16 stable_run() const { return m_run; }
+
+private:
+    bool agrees_with_anchor(const std::string& best_move, i32 score_cp,
+                            const std::optional<uci::WDL>& wdl) const;
+
+    StopRule m_rule;
+    u16 m_last_depth = 0;
+    u16 m_run = 0;
+    bool m_fired = false;
+    // The first depth of the current run.
+    std::string m_anchor_move;
+    i32 m_anchor_score = 0;
+    std::optional<uci::WDL> m_anchor_wdl;
+};
+
+} // namespace vgce::model
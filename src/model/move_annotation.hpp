@@ -0,0 +1,31 @@
+#pragma once
+
+#include "types.hpp"
+#include <string_view>
+
+namespace vgce::model {
+
+constexpr i32 BLUNDER_THRESHOLD_CP = 200;
+constexpr i32 MISTAKE_THRESHOLD_CP = 100;
+constexpr i32 INACCURACY_THRESHOLD_CP = 50;
+constexpr i32 GOOD_THRESHOLD_CP = 30;
+constexpr i32 BRILLIANT_THRESHOLD_CP = 150;
+
+// The annotation for a move that loses loss_cp centipawns for the side that
+// played it; a negative loss is a gain.
+inline std::string_view annotate_move(i32 loss_cp) {
+    if (loss_cp >= BLUNDER_THRESHOLD_CP) {
+        return "??";
+    } else if (loss_cp >= MISTAKE_THRESHOLD_CP) {
+        return "?";
+    } else if (loss_cp >= INACCURACY_THRESHOLD_CP) {
+        return "?!";
+    } else if (loss_cp <= -BRILLIANT_THRESHOLD_CP) {
+        return "!!";
+    } else if (loss_cp < -GOOD_THRESHOLD_CP) {
+        return "!";
+    }
+    return "";
+}
+
+} // namespace vgce::model
@@ -0,0 +1,62 @@
+#include "model/score_history.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace vgce::model {
+
+void ScoreHistory::Series::append(const Point& point) {
+    u32 newest = (m_head + CAPACITY - 1) % CAPACITY;
+    u32 index = m_head;
+    if (m_size > 0 && m_depth[newest] == point.depth) {
+        index = newest;
+    } else {
+        m_head = (m_head + 1) % CAPACITY;
+        m_size = std::min(m_size + 1, CAPACITY);
+    }
+    m_depth[index] = point.depth;
+    m_score[index] = point.score;
+    m_nodes[index] = point.nodes;
+    m_time_ms[index] = point.time_ms;
+}
+
+std::vector<ScoreHistory::Point> ScoreHistory::Series::last(u32 count) const {
+    count = std::min(count, m_size);
+    std::vector<Point> points;
+    points.reserve(count);
+    for (u32 i = CAPACITY - count; i < CAPACITY; ++i) {
+        u32 index = (m_head + i) % CAPACITY;
+        points.push_back({m_depth[index], m_score[index], m_nodes[index], m_time_ms[index]});
+    }
+    return points;
+}
+
+void ScoreHistory::record(const std::string& root_move, u16 multipv, const Point& point) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_moves[root_move].append(point);
+    if (m_slots.size() < multipv) {
+        m_slots.resize(multipv);
+    }
+    m_slots[multipv - 1].append(point);
+}
+
+void ScoreHistory::clear() {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_moves.clear();
+    m_slots.clear();
+}
+
+std::vector<ScoreHistory::Point> ScoreHistory::last_for_move(const std::string& root_move, u32 count) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_moves.find(root_move);
+    return it != m_moves.end() ? it->second.last(count) : std::vector<Point>{};
+}
+
+std::vector<ScoreHistory::Point> ScoreHistory::last_for_slot(u16 multipv, u32 count) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    if (multipv == 0 || multipv > m_slots.size()) {
+        return {};
+    }
+    return m_slots[multipv - 1].last(count);
+}
+
+} // namespace vgce::model
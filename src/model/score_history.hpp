@@ -0,0 +1,56 @@
+#pragma once
+
+#include "types.hpp"
+#include <array>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vgce::model {
+
+// How evaluations evolved over the search, one series per root move and one
+// per MultiPV slot. Each series keeps its latest CAPACITY iterations in
+// fixed column arrays; a later line at the same depth replaces the newest
+// point instead of adding one.
+class ScoreHistory {
+public:
+    static constexpr u32 CAPACITY = 64;
+
+    struct Point {
+        u16 depth = 0;
+        // Centipawns from the root side's point of view; mates are clamped.
+        i32 score = 0;
+        u64 nodes = 0;
+        u32 time_ms = 0;
+    };
+
+    void record(const std::string& root_move, u16 multipv, const Point& point);
+    void clear();
+
+    // Oldest first; at most CAPACITY points.
+    std::vector<Point> last_for_move(const std::string& root_move, u32 count) const;
+    std::vector<Point> last_for_slot(u16 multipv, u32 count) const;
+
+private:
+    class Series {
+    public:
+        void append(const Point& point);
+        std::vector<Point> last(u32 count) const;
+
+    private:
+        std::array<u16, CAPACITY> m_depth{};
+        std::array<i32, CAPACITY> m_score{};
+        std::array<u64, CAPACITY> m_nodes{};
+        std::array<u32, CAPACITY> m_time_ms{};
+        // Slot the next point is written to.
+        u32 m_head = 0;
+        u32 m_size = 0;
+    };
+
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<std::string, Series> m_moves;
+    std::vector<Series> m_slots;
+};
+
+} // namespace vgce::model
@@ -1,79 +1,526 @@
 #include "model/search_tree.hpp"
+#include "metrics/clock.hpp"
+#include "metrics/trace.hpp"
+#include <algorithm>
 #include <iomanip>
+#include <limits>
 #include <sstream>
-#include <functional>
 
 namespace vgce::model {
 
-SearchTree::SearchTree() {
-    m_root = std::make_unique<Node>();
-    m_root->move = "root";
+namespace {
+
+u64 heap_bytes(const std::string& str) {
+    static const u64 INLINE_CAPACITY = std::string().capacity();
+    return str.capacity() > INLINE_CAPACITY ? str.capacity() + 1 : 0;
 }
 
-i32 SearchTree::Node::get_score_cp() const {
-    if (!data.score) {
-        return 0;
+// Control block of a make_shared allocation.
+constexpr u64 SHARED_BLOCK_OVERHEAD = 2 * sizeof(void*);
+// Moves kept in each line summary for the header.
+constexpr u64 SUMMARY_MOVES = 8;
+
+// Orders scores with mates beyond any centipawn value, shorter mates first.
+i64 score_order(const SearchTree::NodeStats& stats) {
+    if (!stats.has_score) {
+        return std::numeric_limits<i32>::min();
     }
-    if (data.score->type == uci::Score::Type::Centipawns) {
-        return data.score->value;
+    if (stats.score_type == uci::Score::Type::Centipawns) {
+        return stats.score;
     }
-    return data.score->value > 0 ? 10000 : -10000;
+    constexpr i64 MATE_BASE = 1'000'000;
+    return stats.score > 0 ? MATE_BASE - stats.score : -MATE_BASE - stats.score;
 }
 
-bool SearchTree::Node::has_score() const {
-    return data.score.has_value();
+// Sibling order for the children of a node at the given ply. Scores are from
+// the root side's point of view, so they flip for the other side. Ties keep
+// their current order.
+bool ranks_before(const SearchTree::Node& a, const SearchTree::Node& b, u16 parent_ply) {
+    constexpr u16 NO_LINE = std::numeric_limits<u16>::max();
+    if (a.is_pv_node != b.is_pv_node) {
+        return a.is_pv_node;
+    }
+    u16 a_line = a.line_refs > 0 ? a.multipv_index : NO_LINE;
+    u16 b_line = b.line_refs > 0 ? b.multipv_index : NO_LINE;
+    if (a_line != b_line) {
+        return a_line < b_line;
+    }
+    if (a.stats.has_score != b.stats.has_score) {
+        return a.stats.has_score;
+    }
+    i64 a_score = score_order(a.stats);
+    i64 b_score = score_order(b.stats);
+    return parent_ply % 2 == 0 ? a_score > b_score : a_score < b_score;
 }
 
-void SearchTree::clear_pv_flags(Node* node) {
-    if (!node) {
-        return;
+// Marks a child written in full rather than as a reference to an earlier one.
+constexpr u32 NEW_NODE = std::numeric_limits<u32>::max();
+
+// Evicting down to this fraction of the budget avoids evicting on every update.
+constexpr u64 EVICTION_TARGET_PERCENT = 90;
+
+// Approximate cost of one std::unordered_map entry including its bucket.
+constexpr u64 INDEX_ENTRY_BYTES = 4 * sizeof(void*) + sizeof(u64);
+
+u64 edge_bytes(const SearchTree::Edge& edge) {
+    return sizeof(SearchTree::Edge) + heap_bytes(edge.san);
+}
+
+u64 node_bytes() {
+    return sizeof(SearchTree::Node) + SHARED_BLOCK_OVERHEAD;
+}
+
+void add_relaxed(std::atomic<u64>& counter, i64 delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + static_cast<u64>(delta),
+                  std::memory_order_relaxed);
+}
+
+} // namespace
+
+static_assert(sizeof(SearchTree::NodeStats) <= 32);
+
+SearchTree::NodeStats SearchTree::NodeStats::from_info(const uci::InfoData& data) {
+    NodeStats stats;
+    stats.nodes = data.nodes.value_or(0);
+    stats.time_ms = static_cast<u32>(std::min<u64>(data.time.value_or(0), std::numeric_limits<u32>::max()));
+    stats.depth = data.depth.value_or(0);
+    stats.seldepth = data.seldepth.value_or(0);
+    if (data.score) {
+        stats.has_score = true;
+        stats.score = data.score->value;
+        stats.score_type = data.score->type;
+        stats.bound = data.score->bound;
     }
-    node->is_pv_node = false;
-    for (auto const& [key, val] : node->children) {
-        clear_pv_flags(val.get());
+    if (data.wdl) {
+        stats.has_wdl = true;
+        stats.wdl = {static_cast<u16>(std::min<u32>(data.wdl->win, 1000)),
+                     static_cast<u16>(std::min<u32>(data.wdl->draw, 1000)),
+                     static_cast<u16>(std::min<u32>(data.wdl->loss, 1000))};
+    }
+    return stats;
+}
+
+SearchTree::SearchTree() {
+    m_root = std::make_shared<Node>();
+}
+
+i32 SearchTree::Node::get_score_cp() const {
+    if (!stats.has_score) {
+        return 0;
     }
+    return stats.get_score().to_cp();
+}
+
+bool SearchTree::Node::has_score() const {
+    return stats.has_score;
 }
 
 void SearchTree::clear() {
     std::unique_lock<std::shared_mutex> lock(m_mutex);
-    m_root = std::make_unique<Node>();
-    m_root->move = "root";
+    reset();
+}
+
+void SearchTree::reset() {
+    m_root = std::make_shared<Node>();
+    m_root->key = m_root_position.key();
+    m_positions.clear();
+    m_slots.clear();
+    m_history.clear();
+    m_node_count.store(0, std::memory_order_relaxed);
+    m_memory_bytes.store(0, std::memory_order_relaxed);
+    m_merged_count.store(0, std::memory_order_relaxed);
+    m_evicted_count.store(0, std::memory_order_relaxed);
+}
+
+void SearchTree::set_root_position(const chess::Position& position) {
+    clear();
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_root_position = position;
+    m_root->key = position.key();
+}
+
+void SearchTree::set_merge_transpositions(bool enabled) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_merge_transpositions = enabled;
+}
+
+void SearchTree::set_memory_budget(u64 bytes) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_memory_budget = bytes;
+}
+
+chess::Position SearchTree::get_root_position() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_root_position;
 }
 
 void SearchTree::update(const uci::InfoData& data) {
     if (data.pv.empty()) {
         return;
     }
+    VGCE_TRACE_SCOPE("tree.update");
 
     std::unique_lock<std::shared_mutex> lock(m_mutex);
 
-    if (!data.multipv || *data.multipv == 1) {
-        clear_pv_flags(m_root.get());
-    }
+    u64 iteration = ++m_update_iteration;
+    u16 multipv = std::max<u16>(data.multipv.value_or(1), 1);
+    std::vector<Node*> path;
+    path.reserve(data.pv.size());
+    LineSummary summary;
+    summary.multipv = multipv;
+    std::string first_move;
 
     Node* current_node = m_root.get();
+    chess::Position position = m_root_position;
     for (const auto& move_str : data.pv) {
-        auto it = current_node->children.find(move_str);
-        if (it == current_node->children.end()) {
-            auto new_node = std::make_unique<Node>();
-            
-            new_node->move = move_str;
-            new_node->parent = current_node;
-            it = current_node->children.emplace(move_str, std::move(new_node)).first;
-        }
-        current_node = it->second.get();
-        
-        if (!data.multipv || *data.multipv == 1) {
-            current_node->is_pv_node = true;
+        // New edges are placed by replace_slot_line once their line is stamped.
+        Edge* edge = follow_move(*current_node, position, move_str);
+        if (!edge) {
+            break;
         }
-        
-        if (data.multipv) {
-            current_node->multipv_index = *data.multipv;
+        current_node = edge->node.get();
+        path.push_back(current_node);
+        if (path.size() == 1) {
+            first_move = edge->san;
+        }
+        if (path.size() <= SUMMARY_MOVES) {
+            summary.moves += (path.size() > 1 ? " " : "") + edge->san;
         }
         
         current_node->visit_count++;
+        current_node->last_update = iteration;
+    }
+    if (current_node == m_root.get()) {
+        return;
+    }
+    current_node->stats = NodeStats::from_info(data);
+    summary.stats = current_node->stats;
+    if (current_node->stats.has_score) {
+        const auto& stats = current_node->stats;
+        m_history.record(first_move, multipv,
+                         {stats.depth, current_node->get_score_cp(), stats.nodes, stats.time_ms});
+    }
+    replace_slot_line(multipv, std::move(path), std::move(summary), std::move(first_move));
+    if (m_memory_budget > 0 && m_memory_bytes.load(std::memory_order_relaxed) > m_memory_budget) {
+        evict_stale_branches();
+    }
+    lock.unlock();
+
+    std::lock_guard<std::mutex> pending_lock(m_pending_mutex);
+    if (!m_pending_update) {
+        m_pending_update = PendingUpdate{data.read_ns, metrics::monotonic_ns()};
+    }
+}
+
+SearchTree::Edge* SearchTree::follow_move(Node& parent, chess::Position& position, std::string_view uci) {
+    auto& children = parent.children;
+    auto it = std::find_if(children.begin(), children.end(),
+                           [&](const Edge& edge) { return chess::matches_uci(edge.move, uci); });
+    if (it != children.end()) {
+        // Validated when the edge was created.
+        position.make_move(it->move);
+        return &*it;
+    }
+    auto move = position.parse_uci_move(uci);
+    if (!move) {
+        return nullptr;
+    }
+    Edge edge;
+    edge.san = position.to_san(*move);
+    edge.move = *move;
+    position.make_move(*move);
+    u16 ply = static_cast<u16>(parent.ply + 1);
+
+    // Only nodes at the same ply are merged, which keeps the graph acyclic.
+    if (m_merge_transpositions) {
+        auto existing = m_positions.find(position.key());
+        if (existing != m_positions.end() && existing->second->ply == ply) {
+            edge.node = existing->second;
+            add_relaxed(m_merged_count, 1);
+        }
+    }
+    if (!edge.node) {
+        edge.node = std::make_shared<Node>();
+        edge.node->key = position.key();
+        edge.node->ply = ply;
+        add_relaxed(m_node_count, 1);
+        add_relaxed(m_memory_bytes, static_cast<i64>(node_bytes()));
+        if (m_merge_transpositions && m_positions.emplace(position.key(), edge.node).second) {
+            add_relaxed(m_memory_bytes, static_cast<i64>(INDEX_ENTRY_BYTES));
+        }
+    }
+    edge.node->parent_count++;
+    add_relaxed(m_memory_bytes, static_cast<i64>(edge_bytes(edge)));
+    children.push_back(std::move(edge));
+    return &children.back();
+}
+
+void SearchTree::graft(u64 root_key, const std::vector<std::string>& path, const uci::InfoData& data) {
+    if (data.pv.empty()) {
+        return;
+    }
+    VGCE_TRACE_SCOPE("tree.graft");
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    if (m_root->key != root_key) {
+        return;
+    }
+    u64 iteration = ++m_update_iteration;
+    // Parents first, for repositioning on the way back.
+    std::vector<Node*> nodes = {m_root.get()};
+    chess::Position position = m_root_position;
+    for (const auto& move_str : path) {
+        auto& children = nodes.back()->children;
+        auto it = std::find_if(children.begin(), children.end(),
+                               [&](const Edge& edge) { return chess::matches_uci(edge.move, move_str); });
+        if (it == children.end()) {
+            return;
+        }
+        position.make_move(it->move);
+        nodes.push_back(it->node.get());
+    }
+    u64 base = nodes.size() - 1;
+    if (base == 0) {
+        return;
+    }
+    for (const auto& move_str : data.pv) {
+        Edge* edge = follow_move(*nodes.back(), position, move_str);
+        if (!edge) {
+            break;
+        }
+        nodes.push_back(edge->node.get());
+        nodes.back()->visit_count++;
+        nodes.back()->last_update = iteration;
+    }
+    if (nodes.size() == base + 1) {
+        return;
+    }
+
+    NodeStats stats = NodeStats::from_info(data);
+    if (nodes[base]->ply % 2 == 1) {
+        stats.score = -stats.score;
+        std::swap(stats.wdl[0], stats.wdl[2]);
+        // A fail-high for the side to move there is a fail-low for the root side.
+        if (stats.bound == uci::Score::Bound::Lower) {
+            stats.bound = uci::Score::Bound::Upper;
+        } else if (stats.bound == uci::Score::Bound::Upper) {
+            stats.bound = uci::Score::Bound::Lower;
+        }
+    }
+    for (u64 i = 1; i < nodes.size(); ++i) {
+        nodes[i]->is_pinned = true;
+        nodes[i]->is_refined |= i >= base;
+    }
+    // The picked node takes the refined eval once it is at least as deep as
+    // the one it has, so a new refinement never makes it worse.
+    if (stats.depth >= nodes[base]->stats.depth) {
+        nodes[base]->stats = stats;
+    }
+    nodes.back()->stats = stats;
+    for (u64 i = nodes.size() - 1; i > 0; --i) {
+        reposition(nodes[i - 1], nodes[i]);
+    }
+    if (m_memory_budget > 0 && m_memory_bytes.load(std::memory_order_relaxed) > m_memory_budget) {
+        evict_stale_branches();
+    }
+    lock.unlock();
+
+    std::lock_guard<std::mutex> pending_lock(m_pending_mutex);
+    if (!m_pending_update) {
+        m_pending_update = PendingUpdate{data.read_ns, metrics::monotonic_ns()};
     }
-    current_node->data = data;
+}
+
+// Costs O(old path + new path). The new line is stamped before the old one
+// is released, so nodes shared by both keep their slot. Nodes left on no
+// line lose their slot and render as ordinary alternatives.
+void SearchTree::replace_slot_line(u16 multipv, std::vector<Node*> path, LineSummary summary,
+                                   std::string first_move) {
+    if (m_slots.size() < multipv) {
+        m_slots.resize(multipv);
+    }
+    Slot& slot = m_slots[multipv - 1];
+    if (multipv == 1) {
+        for (Node* node : slot.path) {
+            node->is_pv_node = false;
+        }
+        for (Node* node : path) {
+            node->is_pv_node = true;
+        }
+    }
+    for (Node* node : path) {
+        node->line_refs++;
+        node->multipv_index = multipv;
+    }
+    for (Node* node : slot.path) {
+        if (--node->line_refs == 0) {
+            node->multipv_index = 0;
+        }
+    }
+
+    // Only the parents along each line are reordered; another parent of a
+    // merged node catches up when one of its own lines changes.
+    for (const auto* line : {&slot.path, &path}) {
+        Node* parent = m_root.get();
+        for (Node* node : *line) {
+            reposition(parent, node);
+            parent = node;
+        }
+    }
+    slot.path = std::move(path);
+    slot.summary = std::move(summary);
+    slot.first_move = std::move(first_move);
+}
+
+std::vector<SearchTree::LineSummary> SearchTree::get_top_lines(u16 count) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<LineSummary> lines;
+    for (const auto& slot : m_slots) {
+        if (!slot.path.empty()) {
+            lines.push_back(slot.summary);
+        }
+    }
+    lock.unlock();
+
+    auto end = lines.begin() + std::min<u64>(count, lines.size());
+    std::partial_sort(lines.begin(), end, lines.end(), [](const LineSummary& a, const LineSummary& b) {
+        return score_order(a.stats) > score_order(b.stats);
+    });
+    lines.erase(end, lines.end());
+    return lines;
+}
+
+std::optional<SearchTree::LineSummary> SearchTree::get_main_line() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    if (m_slots.empty() || m_slots.front().path.empty()) {
+        return std::nullopt;
+    }
+    return m_slots.front().summary;
+}
+
+SearchTree::TopLineMoves SearchTree::get_top_line_moves(u16 count) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<const Slot*> slots;
+    for (const auto& slot : m_slots) {
+        if (!slot.path.empty()) {
+            slots.push_back(&slot);
+        }
+    }
+    auto end = slots.begin() + std::min<u64>(count, slots.size());
+    std::partial_sort(slots.begin(), end, slots.end(), [](const Slot* a, const Slot* b) {
+        return score_order(a->summary.stats) > score_order(b->summary.stats);
+    });
+    slots.erase(end, slots.end());
+
+    TopLineMoves top{m_root_position, {}, {}};
+    for (const Slot* slot : slots) {
+        top.lines.push_back(slot->summary);
+        auto& moves = top.moves.emplace_back();
+        const Node* parent = m_root.get();
+        for (const Node* node : slot->path) {
+            auto it = std::find_if(parent->children.begin(), parent->children.end(),
+                                   [node](const Edge& edge) { return edge.node.get() == node; });
+            if (it == parent->children.end()) {
+                break;
+            }
+            moves.push_back(chess::move_to_uci(it->move));
+            parent = node;
+        }
+    }
+    return top;
+}
+
+// One insertion-sort step: siblings are already in order, so the child only
+// moves past those it now ranks against differently.
+void SearchTree::reposition(Node* parent, const Node* child) {
+    auto& children = parent->children;
+    auto it = std::find_if(children.begin(), children.end(),
+                           [&](const Edge& edge) { return edge.node.get() == child; });
+    if (it == children.end()) {
+        return;
+    }
+    while (it != children.begin() && ranks_before(*it->node, *std::prev(it)->node, parent->ply)) {
+        std::iter_swap(it, std::prev(it));
+        --it;
+    }
+    while (std::next(it) != children.end() && ranks_before(*std::next(it)->node, *it->node, parent->ply)) {
+        std::iter_swap(it, std::next(it));
+        ++it;
+    }
+}
+
+// Candidates are the topmost nodes on no current MultiPV line or grafted
+// line; dropping one drops its subtree. The least recently updated go first.
+void SearchTree::evict_stale_branches() {
+    VGCE_TRACE_SCOPE("tree.evict");
+
+    struct Candidate {
+        Node* parent;
+        const Node* child;
+        u64 last_update;
+        u16 ply;
+    };
+    std::vector<Candidate> candidates;
+    std::vector<Node*> stack{m_root.get()};
+    std::unordered_set<const Node*> visited;
+    while (!stack.empty()) {
+        Node* node = stack.back();
+        stack.pop_back();
+        for (auto& edge : node->children) {
+            Node* child = edge.node.get();
+            if (child->line_refs == 0 && !child->is_pinned) {
+                candidates.push_back({node, child, child->last_update, child->ply});
+            } else if (child->parent_count <= 1 || visited.insert(child).second) {
+                stack.push_back(child);
+            }
+        }
+    }
+
+    // Oldest first; among equally old branches, the deepest go first.
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.last_update != b.last_update ? a.last_update < b.last_update : a.ply > b.ply;
+    });
+
+    u64 target = m_memory_budget / 100 * EVICTION_TARGET_PERCENT;
+    for (const auto& candidate : candidates) {
+        if (m_memory_bytes.load(std::memory_order_relaxed) <= target) {
+            break;
+        }
+        auto& children = candidate.parent->children;
+        auto it = std::find_if(children.begin(), children.end(),
+                               [&](const Edge& edge) { return edge.node.get() == candidate.child; });
+        add_relaxed(m_memory_bytes, -static_cast<i64>(edge_bytes(*it)));
+        if (--it->node->parent_count == 0) {
+            release_subtree(it->node.get());
+        }
+        children.erase(it);
+        add_relaxed(m_evicted_count, 1);
+    }
+}
+
+// Accounts for a node that lost its last parent, and for any descendants
+// that only it referenced. The shared_ptrs free the memory.
+void SearchTree::release_subtree(Node* node) {
+    add_relaxed(m_node_count, -1);
+    add_relaxed(m_memory_bytes, -static_cast<i64>(node_bytes()));
+    auto indexed = m_positions.find(node->key);
+    if (indexed != m_positions.end() && indexed->second.get() == node) {
+        m_positions.erase(indexed);
+        add_relaxed(m_memory_bytes, -static_cast<i64>(INDEX_ENTRY_BYTES));
+    }
+    for (auto& edge : node->children) {
+        add_relaxed(m_memory_bytes, -static_cast<i64>(edge_bytes(edge)));
+        if (--edge.node->parent_count == 0) {
+            release_subtree(edge.node.get());
+        }
+    }
+}
+
+std::optional<SearchTree::PendingUpdate> SearchTree::take_pending_update() {
+    std::lock_guard<std::mutex> lock(m_pending_mutex);
+    auto pending = m_pending_update;
+    m_pending_update.reset();
+    return pending;
 }
 
 std::string SearchTree::get_best_move() const {
@@ -83,49 +530,53 @@ std::string SearchTree::get_best_move() const {
         return "";
     }
     
-    for (const auto& [move, node] : m_root->children) {
-        if (node->is_pv_node) {
-            return move;
-        }
+    if (!m_slots.empty() && !m_slots.front().first_move.empty()) {
+        return m_slots.front().first_move;
     }
     
-    return m_root->children.begin()->first;
+    return m_root->children.front().san;
 }
 
 u64 SearchTree::get_total_nodes() const {
-    std::shared_lock<std::shared_mutex> lock(m_mutex);
-    u64 count = 0;
-    
-    std::function<void(const Node*)> count_nodes = [&](const Node* node) {
-        if (!node) return;
-        count++;
-        for (const auto& [move, child] : node->children) {
-            count_nodes(child.get());
-        }
-    };
-    
-    count_nodes(m_root.get());
-    return count > 0 ? count - 1 : 0;
+    return m_node_count.load(std::memory_order_relaxed);
+}
+
+u64 SearchTree::get_memory_bytes() const {
+    return m_memory_bytes.load(std::memory_order_relaxed);
+}
+
+u64 SearchTree::get_merged_count() const {
+    return m_merged_count.load(std::memory_order_relaxed);
 }
 
-void SearchTree::export_node(const Node* node, std::stringstream& ss, const std::string& prefix, bool is_last, u16 depth) const {
+u64 SearchTree::get_evicted_count() const {
+    return m_evicted_count.load(std::memory_order_relaxed);
+}
+
+void SearchTree::export_node(const Edge& edge, std::stringstream& ss, const std::string& prefix, bool is_last,
+                             u16 depth, std::unordered_set<const Node*>& expanded) const {
+    const Node* node = edge.node.get();
     if (!node || depth > 100) {
         return;
     }
 
-    ss << prefix << (is_last ? "└── " : "├── ") << node->move;
+    ss << prefix << (is_last ? "└── " : "├── ") << edge.san;
     
-    if (node->data.depth) {
-        ss << " (d" << *node->data.depth;
-        if (node->data.seldepth) {
-            ss << "/" << *node->data.seldepth;
+    const auto& stats = node->stats;
+    if (stats.depth) {
+        ss << " (d" << stats.depth;
+        if (stats.seldepth) {
+            ss << "/" << stats.seldepth;
         }
-        if (node->data.score) {
+        if (stats.has_score) {
             ss << ", ";
-            if (node->data.score->type == uci::Score::Type::Centipawns) {
-                ss << std::fixed << std::setprecision(2) << (static_cast<f64>(node->data.score->value) / 100.0);
+            if (stats.bound != uci::Score::Bound::Exact) {
+                ss << (stats.bound == uci::Score::Bound::Lower ? ">=" : "<=");
+            }
+            if (stats.score_type == uci::Score::Type::Centipawns) {
+                ss << std::fixed << std::setprecision(2) << (static_cast<f64>(stats.score) / 100.0);
             } else {
-                ss << "M" << node->data.score->value;
+                ss << "M" << stats.score;
             }
         }
         ss << ")";
@@ -134,8 +585,17 @@ void SearchTree::export_node(const Node* node, std::stringstream& ss, const std:
     if (node->visit_count > 1) {
         ss << " [TT×" << node->visit_count << "]";
     }
+
+    // A merged position's subtree is written once; later paths point back to it.
+    bool is_repeat = node->parent_count > 1 && !expanded.insert(node).second;
+    if (node->parent_count > 1) {
+        ss << (is_repeat ? " [transposes, see above]" : " [joins " + std::to_string(node->parent_count) + " lines]");
+    }
     
     ss << "\n";
+    if (is_repeat) {
+        return;
+    }
 
     const std::string child_prefix = prefix + (is_last ? "    " : "│   ");
     const auto& children = node->children;
@@ -143,7 +603,7 @@ void SearchTree::export_node(const Node* node, std::stringstream& ss, const std:
     auto it = children.begin();
     while (it != children.end()) {
         bool is_child_last = (std::next(it) == children.end());
-        export_node(it->second.get(), ss, child_prefix, is_child_last, depth + 1);
+        export_node(*it, ss, child_prefix, is_child_last, depth + 1, expanded);
         ++it;
     }
 }
@@ -153,20 +613,148 @@ std::string SearchTree::export_to_string() const {
     std::stringstream ss;
     
     ss << "Search Tree:\n";
+    std::unordered_set<const Node*> expanded;
     const auto& children = m_root->children;
     auto it = children.begin();
     while (it != children.end()) {
         bool is_last = (std::next(it) == children.end());
-        export_node(it->second.get(), ss, "", is_last, 1);
+        export_node(*it, ss, "", is_last, 1, expanded);
         ++it;
     }
     
     return ss.str();
 }
 
-const SearchTree::Node* SearchTree::get_root() const {
+// Nodes are written depth first. A merged node is written in full under its
+// first parent and by id under the others.
+void SearchTree::save(std::vector<u8>& out) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    ByteWriter writer(out);
+    writer.put_string(m_root_position.to_fen());
+    writer.put(m_update_iteration);
+    writer.put(m_merged_count.load(std::memory_order_relaxed));
+    writer.put(m_evicted_count.load(std::memory_order_relaxed));
+    std::unordered_map<const Node*, u32> ids;
+    save_node(*m_root, writer, ids);
+
+    // Lines are stored as child positions from the root.
+    writer.put(static_cast<u16>(m_slots.size()));
+    for (const auto& slot : m_slots) {
+        writer.put(static_cast<u16>(slot.path.size()));
+        const Node* parent = m_root.get();
+        for (const Node* node : slot.path) {
+            auto it = std::find_if(parent->children.begin(), parent->children.end(),
+                                   [&](const Edge& edge) { return edge.node.get() == node; });
+            writer.put(static_cast<u16>(it - parent->children.begin()));
+            parent = node;
+        }
+        writer.put(slot.summary.stats);
+        writer.put_string(slot.summary.moves);
+        writer.put_string(slot.first_move);
+    }
+}
+
+void SearchTree::save_node(const Node& node, ByteWriter& writer,
+                           std::unordered_map<const Node*, u32>& ids) const {
+    writer.put(node.key);
+    writer.put(node.ply);
+    writer.put(node.stats);
+    writer.put(node.visit_count);
+    writer.put(node.last_update);
+    writer.put(static_cast<u16>(node.children.size()));
+    for (const auto& edge : node.children) {
+        writer.put(edge.move.raw());
+        writer.put_string(edge.san);
+        auto [it, inserted] = ids.emplace(edge.node.get(), static_cast<u32>(ids.size()));
+        if (inserted) {
+            writer.put(NEW_NODE);
+            save_node(*edge.node, writer, ids);
+        } else {
+            writer.put(it->second);
+        }
+    }
+}
+
+void SearchTree::restore(std::span<const u8> data) {
+    VGCE_TRACE_SCOPE("tree.restore");
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    reset();
+    try {
+        ByteReader reader(data);
+        m_root_position = chess::Position::from_fen(reader.get_string());
+        m_update_iteration = reader.get<u64>();
+        m_merged_count.store(reader.get<u64>(), std::memory_order_relaxed);
+        m_evicted_count.store(reader.get<u64>(), std::memory_order_relaxed);
+        std::vector<std::shared_ptr<Node>> nodes;
+        restore_node(*m_root, reader, nodes);
+
+        u16 slot_count = reader.get<u16>();
+        for (u16 multipv = 1; multipv <= slot_count; ++multipv) {
+            std::vector<Node*> path(reader.get<u16>());
+            Node* parent = m_root.get();
+            for (auto& node : path) {
+                u16 child = reader.get<u16>();
+                if (child >= parent->children.size()) {
+                    throw std::runtime_error("Saved line leaves the tree");
+                }
+                node = parent->children[child].node.get();
+                parent = node;
+            }
+            LineSummary summary;
+            summary.multipv = multipv;
+            summary.stats = reader.get<NodeStats>();
+            summary.moves = reader.get_string();
+            std::string first_move = reader.get_string();
+            if (!path.empty()) {
+                replace_slot_line(multipv, std::move(path), std::move(summary), std::move(first_move));
+            }
+        }
+    } catch (...) {
+        reset();
+        throw;
+    }
+}
+
+void SearchTree::restore_node(Node& node, ByteReader& reader, std::vector<std::shared_ptr<Node>>& nodes) {
+    node.key = reader.get<u64>();
+    node.ply = reader.get<u16>();
+    node.stats = reader.get<NodeStats>();
+    node.visit_count = reader.get<u64>();
+    node.last_update = reader.get<u64>();
+    u16 child_count = reader.get<u16>();
+    node.children.reserve(child_count);
+    for (u16 i = 0; i < child_count; ++i) {
+        Edge edge;
+        edge.move = chess::Move::from_raw(reader.get<u16>());
+        edge.san = reader.get_string();
+        u32 id = reader.get<u32>();
+        if (id == NEW_NODE) {
+            edge.node = std::make_shared<Node>();
+            nodes.push_back(edge.node);
+            add_relaxed(m_node_count, 1);
+            add_relaxed(m_memory_bytes, static_cast<i64>(node_bytes()));
+            restore_node(*edge.node, reader, nodes);
+            if (m_merge_transpositions && m_positions.emplace(edge.node->key, edge.node).second) {
+                add_relaxed(m_memory_bytes, static_cast<i64>(INDEX_ENTRY_BYTES));
+            }
+        } else if (id < nodes.size()) {
+            edge.node = nodes[id];
+        } else {
+            throw std::runtime_error("Saved tree refers to an unknown node");
+        }
+        edge.node->parent_count++;
+        add_relaxed(m_memory_bytes, static_cast<i64>(edge_bytes(edge)));
+        node.children.push_back(std::move(edge));
+    }
+}
+
+const ScoreHistory& SearchTree::get_history() const {
+    return m_history;
+}
+
+void SearchTree::with_root(const std::function<void(const Node&)>& fn) const {
     std::shared_lock<std::shared_mutex> lock(m_mutex);
-    return m_root.get();
+    fn(*m_root);
 }
 
 } // namespace vgce::model
@@ -1,46 +1,198 @@
 #pragma once
 
+#include "byte_buffer.hpp"
+#include "chess/position.hpp"
+#include "model/score_history.hpp"
 #include "uci/uci_data.hpp"
-#include <map>
+#include <array>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <shared_mutex>
+#include <span>
 #include <string>
 #include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace vgce::model {
 
 class SearchTree {
 public:
+    // The oldest update not yet shown on screen.
+    struct PendingUpdate {
+        u64 read_ns;
+        u64 tree_ns;
+    };
+
+    // The parts of an info line shown per node, in 32 bytes. Zero depth
+    // means unknown. The raw line is only kept in the engine log.
+    struct NodeStats {
+        u64 nodes = 0;
+        u32 time_ms = 0;
+        i32 score = 0;
+        u16 depth = 0;
+        u16 seldepth = 0;
+        // Per mille.
+        std::array<u16, 3> wdl{};
+        uci::Score::Type score_type = uci::Score::Type::Centipawns;
+        uci::Score::Bound bound = uci::Score::Bound::Exact;
+        bool has_score = false;
+        bool has_wdl = false;
+
+        static NodeStats from_info(const uci::InfoData& data);
+        uci::Score get_score() const { return uci::Score{score_type, score, bound}; }
+    };
+
+    struct Node;
+
+    // Moves live on edges because merged positions can be reached by
+    // different last moves.
+    struct Edge {
+        std::string san;
+        chess::Move move;
+        std::shared_ptr<Node> node;
+    };
+
     struct Node {
-        std::string move;
-        uci::InfoData data;
+        // Zobrist key of the position.
+        u64 key = 0;
+        u16 ply = 0;
+        // More than one when transposition merging joined several lines here.
+        u16 parent_count = 0;
+        NodeStats stats;
         u64 visit_count = 0;
+        // Update iteration that last passed through this node.
+        u64 last_update = 0;
+        // Latest MultiPV slot to pass through this node; 0 once no current
+        // line does.
         u16 multipv_index = 0;
+        // Number of current MultiPV lines through this node.
+        u16 line_refs = 0;
+        // On the current line of the first slot.
         bool is_pv_node = false;
-        std::map<std::string, std::unique_ptr<Node>> children;
-        Node* parent = nullptr;
+        // Searched on its own by a refinement engine; not saved in checkpoints.
+        bool is_refined = false;
+        // On a grafted line, so kept from eviction until the root changes.
+        bool is_pinned = false;
+        // Best first: the main line, other current MultiPV lines by slot,
+        // then the rest by score for the side to move here.
+        std::vector<Edge> children;
         
         i32 get_score_cp() const;
         bool has_score() const;
     };
 
+    struct LineSummary {
+        u16 multipv = 0;
+        NodeStats stats;
+        // The first few moves in SAN.
+        std::string moves;
+    };
+
+    struct TopLineMoves {
+        chess::Position root_position;
+        std::vector<LineSummary> lines;
+        // Each line's full path in UCI moves, parallel to lines.
+        std::vector<std::vector<std::string>> moves;
+    };
+
 public:
     SearchTree();
 
+    // PV moves are replayed from the root position; a PV is cut at its
+    // first illegal move.
     void update(const uci::InfoData& data);
+    // Grafts a line searched from the node that path (UCI moves) reaches
+    // from the root with the given key. Nodes it touches are marked refined
+    // and, with the path to them, pinned against eviction; the scores are
+    // turned to the root side's view and the MultiPV lines are left alone.
+    // Ignored once the root or the path is gone.
+    void graft(u64 root_key, const std::vector<std::string>& path, const uci::InfoData& data);
     void clear();
-    const Node* get_root() const;
+    // Also clears the tree, whose moves only make sense from the old root.
+    void set_root_position(const chess::Position& position);
+    chess::Position get_root_position() const;
+    // Positions reached by different move orders at the same ply share one
+    // node, turning the tree into a DAG. Takes effect for new nodes.
+    void set_merge_transpositions(bool enabled);
+    // Once the tree's estimated size passes the budget, branches off the
+    // current MultiPV lines are evicted, least recently updated first.
+    // Zero means unlimited.
+    void set_memory_budget(u64 bytes);
+    // Writes the tree, its root position and the MultiPV lines for session
+    // checkpoints. Score history is not included.
+    void save(std::vector<u8>& out) const;
+    // Replaces the tree with a saved one; throws std::runtime_error on
+    // malformed data and leaves the tree empty.
+    void restore(std::span<const u8> data);
+    // Runs fn under the read lock, so the tree cannot change while it is walked.
+    void with_root(const std::function<void(const Node&)>& fn) const;
     std::string get_best_move() const;
     std::string export_to_string() const;
     
+    // Maintained incrementally, so both are cheap to read every frame.
     u64 get_total_nodes() const;
+    u64 get_memory_bytes() const;
+    // Edges that joined an existing node instead of creating a subtree.
+    u64 get_merged_count() const;
+    u64 get_evicted_count() const;
+    // Current MultiPV lines sorted by score, best first; reads the slot
+    // table only.
+    std::vector<LineSummary> get_top_lines(u16 count) const;
+    // The first MultiPV slot's line, which get_best_move() plays; with
+    // several slots a stale one can outscore it in get_top_lines().
+    std::optional<LineSummary> get_main_line() const;
+    // As get_top_lines, plus each line's UCI moves and the root they start
+    // from, all read under one lock so they agree with each other.
+    TopLineMoves get_top_line_moves(u16 count) const;
+    // Scored lines per root move and slot; locks on its own.
+    const ScoreHistory& get_history() const;
+
+    // Returns and clears the pending update marker; called once per frame.
+    std::optional<PendingUpdate> take_pending_update();
 
 private:
-    void clear_pv_flags(Node* node);
-    void export_node(const Node* node, std::stringstream& ss, const std::string& prefix, bool is_last, u16 depth) const;
+    // The current line of one MultiPV slot.
+    struct Slot {
+        std::vector<Node*> path;
+        LineSummary summary;
+        std::string first_move;
+    };
 
-    std::unique_ptr<Node> m_root;
+    void reset();
+    // Follows the edge for a UCI move, adding it if the move is legal here,
+    // and plays it on position. Returns nullptr for an illegal move.
+    Edge* follow_move(Node& parent, chess::Position& position, std::string_view uci);
+    void save_node(const Node& node, ByteWriter& writer, std::unordered_map<const Node*, u32>& ids) const;
+    void restore_node(Node& node, ByteReader& reader, std::vector<std::shared_ptr<Node>>& nodes);
+    void replace_slot_line(u16 multipv, std::vector<Node*> path, LineSummary summary,
+                           std::string first_move);
+    // Moves a child whose rank changed to its place among its siblings.
+    void reposition(Node* parent, const Node* child);
+    void evict_stale_branches();
+    void release_subtree(Node* node);
+    void export_node(const Edge& edge, std::stringstream& ss, const std::string& prefix, bool is_last,
+                     u16 depth, std::unordered_set<const Node*>& expanded) const;
+
+    std::shared_ptr<Node> m_root;
+    chess::Position m_root_position = chess::Position::from_string("startpos");
     mutable std::shared_mutex m_mutex;
+    bool m_merge_transpositions = false;
+    u64 m_memory_budget = 0;
+    u64 m_update_iteration = 0;
+    std::vector<Slot> m_slots;
+    ScoreHistory m_history;
+    std::unordered_map<u64, std::shared_ptr<Node>> m_positions;
+    std::atomic<u64> m_node_count{0};
+    std::atomic<u64> m_memory_bytes{0};
+    std::atomic<u64> m_merged_count{0};
+    std::atomic<u64> m_evicted_count{0};
+
+    std::optional<PendingUpdate> m_pending_update;
+    std::mutex m_pending_mutex;
 };
 
 } // namespace vgce::model
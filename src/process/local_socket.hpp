@@ -0,0 +1,56 @@
+#pragma once
+
+#include "types.hpp"
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+namespace vgce::process {
+
+// A Unix-domain stream socket (AF_UNIX also exists on Windows 10 and later),
+// or a TCP socket on the loopback interface. Sends never block, so one slow
+// peer cannot hold up its sender.
+class LocalSocket {
+public:
+    // Listens on path, replacing a socket file nobody is listening on.
+    // Throws std::runtime_error if the path is in use or cannot be bound.
+    static LocalSocket listen(const std::filesystem::path& path);
+    // Listens on 127.0.0.1:port. Throws std::runtime_error if the port is
+    // taken.
+    static LocalSocket listen_loopback(u16 port);
+    // Throws std::runtime_error if nothing is listening on path.
+    static LocalSocket connect(const std::filesystem::path& path);
+
+    LocalSocket() = default;
+    ~LocalSocket();
+
+    LocalSocket(const LocalSocket&) = delete;
+    LocalSocket& operator=(const LocalSocket&) = delete;
+    LocalSocket(LocalSocket&& other) noexcept;
+    LocalSocket& operator=(LocalSocket&& other) noexcept;
+
+    // Returns nothing when no peer is waiting.
+    std::optional<LocalSocket> accept();
+    // Sends as much as fits in the socket buffer. Returns the bytes sent, or
+    // -1 once the peer is gone.
+    i64 send_some(std::span<const u8> bytes);
+    // Waits up to timeout for data. Returns the bytes received, 0 if none
+    // arrived, or -1 once the peer is gone.
+    i64 receive(std::span<u8> buffer, std::chrono::milliseconds timeout);
+
+    bool is_open() const { return m_handle != INVALID_HANDLE; }
+
+private:
+    static constexpr i64 INVALID_HANDLE = -1;
+
+    explicit LocalSocket(i64 handle) : m_handle(handle) {}
+    void close();
+
+    // A file descriptor, or a SOCKET on Windows.
+    i64 m_handle = INVALID_HANDLE;
+    // The socket file a listener removes when it closes.
+    std::filesystem::path m_path;
+};
+
+} // namespace vgce::process
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "types.hpp"
+#include <filesystem>
+#include <span>
+
+namespace vgce::process {
+
+// A mapping of a whole file, so opening a large file costs nothing until its
+// pages are touched. Throws std::runtime_error if the file cannot be mapped.
+class MappedFile {
+public:
+    // Read-only.
+    explicit MappedFile(const std::filesystem::path& path);
+    // Shared and writable; the file is created or extended to at least size
+    // bytes, with new bytes zeroed.
+    MappedFile(const std::filesystem::path& path, u64 size);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::span<const u8> bytes() const { return {m_data, m_size}; }
+    // Empty for a read-only mapping.
+    std::span<u8> writable_bytes() const { return m_writable ? std::span<u8>{m_data, m_size} : std::span<u8>{}; }
+    // Starts writing dirty pages back without waiting.
+    void flush();
+
+private:
+    u8* m_data = nullptr;
+    bool m_writable = false;
+    u64 m_size = 0;
+    // The mapping object on Windows; unused elsewhere.
+    void* m_handle = nullptr;
+};
+
+} // namespace vgce::process
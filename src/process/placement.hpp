@@ -0,0 +1,89 @@
+#pragma once
+
+#include "types.hpp"
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace vgce::process {
+
+enum class SchedPolicy { Default, Other, Batch, Idle, Fifo, RoundRobin };
+
+// CPU placement for a process or thread. Empty/unset fields leave the
+// inherited setting untouched.
+struct Placement {
+    std::vector<u32> cpus;
+    std::optional<u32> numa_node;
+    bool auto_numa = false;
+    std::optional<i32> nice;
+    SchedPolicy policy = SchedPolicy::Default;
+    i32 rt_priority = 1;
+
+    bool empty() const {
+        return cpus.empty() && !numa_node && !auto_numa && !nice &&
+               policy == SchedPolicy::Default;
+    }
+};
+
+u32 numa_node_count();
+std::vector<u32> numa_node_cpus(u32 node);
+
+// Round-robin node assignment so that engines launched with auto placement
+// end up on different NUMA nodes.
+u32 next_numa_node();
+
+// Resolves auto/numa placement into a concrete CPU set.
+Placement resolve_placement(const Placement& placement);
+
+bool apply_to_current_thread(const Placement& placement);
+
+// Parses a Linux-style CPU list such as "0-3,8,10-11".
+inline std::optional<std::vector<u32>> parse_cpu_list(std::string_view list) {
+    std::vector<u32> cpus;
+    while (!list.empty()) {
+        auto comma = list.find(',');
+        std::string_view part = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+        auto dash = part.find('-');
+        std::string_view first_sv = part.substr(0, dash);
+        std::string_view last_sv = dash == std::string_view::npos ? first_sv : part.substr(dash + 1);
+
+        u32 first{};
+        u32 last{};
+        auto r1 = std::from_chars(first_sv.data(), first_sv.data() + first_sv.size(), first);
+        auto r2 = std::from_chars(last_sv.data(), last_sv.data() + last_sv.size(), last);
+        if (r1.ec != std::errc() || r2.ec != std::errc() || last < first) {
+            return std::nullopt;
+        }
+        for (u32 cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) {
+        return std::nullopt;
+    }
+    return cpus;
+}
+
+inline std::optional<SchedPolicy> parse_sched_policy(std::string_view name) {
+    if (name == "other") {
+        return SchedPolicy::Other;
+    }
+    if (name == "batch") {
+        return SchedPolicy::Batch;
+    }
+    if (name == "idle") {
+        return SchedPolicy::Idle;
+    }
+    if (name == "fifo") {
+        return SchedPolicy::Fifo;
+    }
+    if (name == "rr") {
+        return SchedPolicy::RoundRobin;
+    }
+    return std::nullopt;
+}
+
+} // namespace vgce::process
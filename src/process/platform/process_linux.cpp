@@ -1,56 +1,352 @@
 #include "process/process.hpp"
+#include "metrics/clock.hpp"
+#include "metrics/latency_histogram.hpp"
+#include "metrics/trace.hpp"
+#include "process/local_socket.hpp"
+#include "process/mapped_file.hpp"
+#include "process/shared_memory.hpp"
+#include "process/resource_usage.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <charconv>
+#include <chrono>
 #include <csignal>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <netinet/in.h>
 #include <poll.h>
+#include <sched.h>
+#include <spawn.h>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <utility>
 #include <vector>
 
 namespace vgce::process {
 
-class Process::ProcessImpl {
-public:
-    ProcessImpl(const std::filesystem::path& executable,
-                const std::vector<std::string>& args) {
-        if (pipe(m_engine_stdin_pipe) < 0 || pipe(m_engine_stdout_pipe) < 0) {
-            throw std::runtime_error("Pipe creation failed");
+namespace {
+
+constexpr int READ_POLL_TIMEOUT_MS = 5;
+constexpr u64 READ_CHUNK_SIZE = 64 * 1024;
+constexpr u64 COMPACT_THRESHOLD = 64 * 1024;
+
+constexpr int MPOL_DEFAULT_MODE = 0;
+constexpr int MPOL_BIND_MODE = 2;
+constexpr u32 MAX_NUMA_NODES = 64;
+
+int to_native_policy(SchedPolicy policy) {
+    switch (policy) {
+    case SchedPolicy::Batch:
+        return SCHED_BATCH;
+    case SchedPolicy::Idle:
+        return SCHED_IDLE;
+    case SchedPolicy::Fifo:
+        return SCHED_FIFO;
+    case SchedPolicy::RoundRobin:
+        return SCHED_RR;
+    default:
+        return SCHED_OTHER;
+    }
+}
+
+// Only uses raw syscalls so it is safe to call between fork() and exec().
+bool apply_placement(const Placement& placement, const cpu_set_t* cpu_set) {
+    bool ok = true;
+    if (cpu_set && sched_setaffinity(0, sizeof(cpu_set_t), cpu_set) != 0) {
+        ok = false;
+    }
+    if (placement.numa_node && *placement.numa_node < MAX_NUMA_NODES) {
+        unsigned long node_mask = 1UL << *placement.numa_node;
+        if (syscall(SYS_set_mempolicy, MPOL_BIND_MODE, &node_mask, MAX_NUMA_NODES + 1) != 0) {
+            ok = false;
+        }
+    }
+    if (placement.policy != SchedPolicy::Default) {
+        sched_param param{};
+        if (placement.policy == SchedPolicy::Fifo || placement.policy == SchedPolicy::RoundRobin) {
+            param.sched_priority = placement.rt_priority;
         }
+        if (sched_setscheduler(0, to_native_policy(placement.policy), &param) != 0) {
+            ok = false;
+        }
+    }
+    if (placement.nice && setpriority(PRIO_PROCESS, 0, *placement.nice) != 0) {
+        ok = false;
+    }
+    return ok;
+}
 
-        m_pid = fork();
-        if (m_pid < 0) {
-            throw std::runtime_error("Fork failed");
+// vgce may pin its own threads; engines must not inherit that placement.
+struct InheritedPlacement {
+    cpu_set_t affinity;
+    int nice;
+
+    InheritedPlacement() {
+        CPU_ZERO(&affinity);
+        sched_getaffinity(0, sizeof(cpu_set_t), &affinity);
+        errno = 0;
+        nice = getpriority(PRIO_PROCESS, 0);
+    }
+};
+
+const InheritedPlacement g_inherited_placement;
+
+cpu_set_t to_cpu_set(const std::vector<u32>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (u32 cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
         }
+    }
+    return set;
+}
 
-        if (m_pid == 0) {
-            dup2(m_engine_stdin_pipe[0], STDIN_FILENO);
-            dup2(m_engine_stdout_pipe[1], STDOUT_FILENO);
-            dup2(m_engine_stdout_pipe[1], STDERR_FILENO);
+std::string read_small_file(const std::string& path) {
+    std::string content;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return content;
+    }
+    char chunk[4096];
+    ssize_t bytes_read;
+    while ((bytes_read = read(fd, chunk, sizeof(chunk))) > 0) {
+        content.append(chunk, static_cast<u64>(bytes_read));
+    }
+    close(fd);
+    return content;
+}
 
-            close(m_engine_stdin_pipe[0]);
-            close(m_engine_stdin_pipe[1]);
-            close(m_engine_stdout_pipe[0]);
-            close(m_engine_stdout_pipe[1]);
+u64 parse_u64(std::string_view sv) {
+    u64 value = 0;
+    std::from_chars(sv.data(), sv.data() + sv.size(), value);
+    return value;
+}
+
+// Fields of /proc/<pid>/stat after the parenthesised command name, starting
+// with field 3 (state).
+std::vector<std::string_view> stat_fields(std::string_view stat) {
+    std::vector<std::string_view> fields;
+    auto close_paren = stat.rfind(')');
+    if (close_paren == std::string_view::npos || close_paren + 2 > stat.size()) {
+        return fields;
+    }
+    stat.remove_prefix(close_paren + 2);
+    while (!stat.empty()) {
+        auto space = stat.find(' ');
+        fields.push_back(stat.substr(0, space));
+        if (space == std::string_view::npos) {
+            break;
+        }
+        stat.remove_prefix(space + 1);
+    }
+    return fields;
+}
 
-            std::vector<char*> c_args;
-            c_args.push_back(const_cast<char*>(executable.c_str()));
-            for (const auto& arg : args) {
-                c_args.push_back(const_cast<char*>(arg.c_str()));
+u64 status_value(std::string_view status, std::string_view key) {
+    auto pos = status.find(key);
+    if (pos == std::string_view::npos) {
+        return 0;
+    }
+    auto value = status.substr(pos + key.size());
+    value.remove_prefix(std::min(value.find_first_not_of(" \t"), value.size()));
+    return parse_u64(value.substr(0, value.find_first_of(" \n")));
+}
+
+// Blocks until everything is written, so a slow reader holds us back just as
+// it would hold back the engine.
+bool write_all(int fd, const char* data, u64 size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0) {
+            if (errno == EAGAIN) {
+                struct pollfd pfd = {fd, POLLOUT, 0};
+                poll(&pfd, 1, -1);
+            } else if (errno != EINTR) {
+                return false;
             }
-            c_args.push_back(nullptr);
+            continue;
+        }
+        data += written;
+        size -= static_cast<u64>(written);
+    }
+    return true;
+}
 
-            execvp(executable.c_str(), c_args.data());
-            perror("execvp");
-            exit(1);
+sockaddr_un socket_address(const std::filesystem::path& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.native().size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: '" + path.string() + "'");
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.native().size());
+    return address;
+}
+
+constexpr u64 STAT_UTIME = 14 - 3;
+constexpr u64 STAT_STIME = 15 - 3;
+constexpr u64 STAT_RSS = 24 - 3;
+constexpr u64 STAT_PROCESSOR = 39 - 3;
+
+} // namespace
+
+i64 current_process_id() {
+    return static_cast<i64>(getpid());
+}
+
+u32 online_cpu_count() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? static_cast<u32>(count) : 1;
+}
+
+std::optional<ResourceUsage> read_resource_usage(i64 pid) {
+    static const u64 ns_per_tick = 1'000'000'000ULL / static_cast<u64>(sysconf(_SC_CLK_TCK));
+    static const u64 page_size = static_cast<u64>(sysconf(_SC_PAGESIZE));
+
+    const std::string base = "/proc/" + std::to_string(pid);
+    auto fields = stat_fields(read_small_file(base + "/stat"));
+    if (fields.size() <= STAT_PROCESSOR) {
+        return std::nullopt;
+    }
+
+    ResourceUsage usage;
+    usage.cpu_time_ns =
+        (parse_u64(fields[STAT_UTIME]) + parse_u64(fields[STAT_STIME])) * ns_per_tick;
+    usage.rss_bytes = parse_u64(fields[STAT_RSS]) * page_size;
+
+    // Context switches and run delay are only reported per thread.
+    DIR* task_dir = opendir((base + "/task").c_str());
+    if (!task_dir) {
+        return usage;
+    }
+    while (dirent* entry = readdir(task_dir)) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+            continue;
+        }
+        const std::string task = base + "/task/" + entry->d_name;
+        auto task_fields = stat_fields(read_small_file(task + "/stat"));
+        if (task_fields.size() <= STAT_PROCESSOR) {
+            continue;
+        }
+        ThreadUsage thread;
+        thread.tid = static_cast<i64>(parse_u64(entry->d_name));
+        thread.cpu_time_ns =
+            (parse_u64(task_fields[STAT_UTIME]) + parse_u64(task_fields[STAT_STIME])) *
+            ns_per_tick;
+        thread.processor = static_cast<u32>(parse_u64(task_fields[STAT_PROCESSOR]));
+        usage.threads.push_back(thread);
+
+        std::string status = read_small_file(task + "/status");
+        usage.voluntary_switches += status_value(status, "\nvoluntary_ctxt_switches:");
+        usage.involuntary_switches += status_value(status, "\nnonvoluntary_ctxt_switches:");
+
+        std::string schedstat = read_small_file(task + "/schedstat");
+        auto first_space = schedstat.find(' ');
+        if (first_space != std::string::npos) {
+            std::string_view rest = std::string_view(schedstat).substr(first_space + 1);
+            usage.run_delay_ns += parse_u64(rest.substr(0, rest.find(' ')));
+        }
+    }
+    closedir(task_dir);
+    return usage;
+}
+
+u32 numa_node_count() {
+    static const u32 count = [] {
+        u32 nodes = 0;
+        while (nodes < MAX_NUMA_NODES &&
+               std::filesystem::exists("/sys/devices/system/node/node" + std::to_string(nodes))) {
+            ++nodes;
+        }
+        return nodes > 0 ? nodes : 1;
+    }();
+    return count;
+}
+
+std::vector<u32> numa_node_cpus(u32 node) {
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    if (!file || !std::getline(file, list)) {
+        return {};
+    }
+    return parse_cpu_list(list).value_or(std::vector<u32>{});
+}
+
+u32 next_numa_node() {
+    static std::atomic<u32> next{0};
+    return next.fetch_add(1) % numa_node_count();
+}
+
+Placement resolve_placement(const Placement& placement) {
+    Placement resolved = placement;
+    if (resolved.auto_numa && !resolved.numa_node && numa_node_count() > 1) {
+        resolved.numa_node = next_numa_node();
+    }
+    if (resolved.numa_node && resolved.cpus.empty()) {
+        resolved.cpus = numa_node_cpus(*resolved.numa_node);
+    }
+    return resolved;
+}
+
+bool apply_to_current_thread(const Placement& placement) {
+    Placement resolved = resolve_placement(placement);
+    if (resolved.cpus.empty()) {
+        return apply_placement(resolved, nullptr);
+    }
+    cpu_set_t set = to_cpu_set(resolved.cpus);
+    return apply_placement(resolved, &set);
+}
+
+class Process::ProcessImpl {
+public:
+    ProcessImpl(const std::filesystem::path& executable, const std::vector<std::string>& args,
+                const Placement& placement, u64 pipe_size) {
+        Placement resolved = resolve_placement(placement);
+
+        std::vector<char*> c_args;
+        c_args.push_back(const_cast<char*>(executable.c_str()));
+        for (const auto& arg : args) {
+            c_args.push_back(const_cast<char*>(arg.c_str()));
+        }
+        c_args.push_back(nullptr);
+
+        if (pipe2(m_engine_stdin_pipe, O_CLOEXEC) < 0 ||
+            pipe2(m_engine_stdout_pipe, O_CLOEXEC) < 0) {
+            throw std::runtime_error("Pipe creation failed");
+        }
+        m_pipe->capacity.store(grow_pipe(m_engine_stdout_pipe[0], pipe_size));
+        fcntl(m_engine_stdout_pipe[0], F_SETFL,
+              fcntl(m_engine_stdout_pipe[0], F_GETFL) | O_NONBLOCK);
+
+        // posix_spawn can neither set a nice value nor SCHED_BATCH/SCHED_IDLE, so
+        // only those placements still pay for a full fork().
+        if (resolved.nice || resolved.policy == SchedPolicy::Batch ||
+            resolved.policy == SchedPolicy::Idle) {
+            spawn_with_fork(executable, c_args, resolved);
         } else {
-            close(m_engine_stdin_pipe[0]);
-            close(m_engine_stdout_pipe[1]);
-            m_engine_stdin_write_fd = m_engine_stdin_pipe[1];
-            m_engine_stdout_read_fd = m_engine_stdout_pipe[0];
+            spawn_with_posix_spawn(executable, c_args, resolved);
         }
+
+        close(m_engine_stdin_pipe[0]);
+        close(m_engine_stdout_pipe[1]);
+        m_engine_stdin_write_fd = m_engine_stdin_pipe[1];
+        m_engine_stdout_read_fd = m_engine_stdout_pipe[0];
     }
 
     ~ProcessImpl() {
@@ -61,6 +357,10 @@ public:
         close(m_engine_stdout_read_fd);
     }
 
+    i64 pid() const {
+        return static_cast<i64>(m_pid);
+    }
+
     bool is_running() const {
         if (m_pid <= 0) {
             return false;
@@ -77,23 +377,54 @@ public:
         return bytes_written == static_cast<ssize_t>(full_line.length());
     }
 
-    std::optional<std::string> read_line() {
+    std::optional<Line> read_line() {
+        drain();
+        if (auto line = extract_line()) {
+            return line;
+        }
+
         struct pollfd pfd = {m_engine_stdout_read_fd, POLLIN, 0};
-        if (poll(&pfd, 1, 0) > 0) {
-            char buffer[4096];
-            ssize_t bytes_read = read(m_engine_stdout_read_fd, buffer, sizeof(buffer) - 1);
-            if (bytes_read > 0) {
-                buffer[bytes_read] = '\0';
-                m_buffer += buffer;
-            }
+        if (poll(&pfd, 1, READ_POLL_TIMEOUT_MS) > 0) {
+            drain();
         }
+        return extract_line();
+    }
 
-        if (auto pos = m_buffer.find('\n'); pos != std::string::npos) {
-            std::string line = m_buffer.substr(0, pos);
-            m_buffer.erase(0, pos + 1);
-            return line;
+    const std::shared_ptr<PipeCounters>& pipe_counters() const { return m_pipe; }
+
+    void mirror_output(int fd, metrics::LatencyHistogram* forward_latency) {
+        m_mirror_latency.store(forward_latency, std::memory_order_relaxed);
+        m_mirror_fd.store(fd, std::memory_order_release);
+    }
+
+    i64 forward_input(int fd, std::string& copy, metrics::LatencyHistogram* forward_latency) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, READ_POLL_TIMEOUT_MS) <= 0) {
+            return 0;
         }
-        return std::nullopt;
+        u64 woke_ns = metrics::monotonic_ns();
+        char chunk[READ_CHUNK_SIZE];
+        ssize_t teed = m_input_is_pipe
+                           ? tee(fd, m_engine_stdin_write_fd, sizeof(chunk), SPLICE_F_NONBLOCK)
+                           : -1;
+        if (teed < 0 && errno == EINVAL) {
+            m_input_is_pipe = false;
+        }
+        // What was teed is still queued on fd; reading exactly that keeps
+        // the parsed copy in step with what the engine got.
+        ssize_t bytes_read = read(fd, chunk, teed > 0 ? static_cast<u64>(teed) : sizeof(chunk));
+        if (bytes_read < 0 && (errno == EINTR || errno == EAGAIN)) {
+            return 0;
+        }
+        if (bytes_read <= 0 ||
+            (teed <= 0 && !write_all(m_engine_stdin_write_fd, chunk, static_cast<u64>(bytes_read)))) {
+            return -1;
+        }
+        if (forward_latency) {
+            forward_latency->record(metrics::monotonic_ns() - woke_ns);
+        }
+        copy.append(chunk, static_cast<u64>(bytes_read));
+        return bytes_read;
     }
 
     void terminate() {
@@ -106,25 +437,478 @@ public:
     }
 
 private:
+    static u64 grow_pipe(int fd, u64 requested) {
+        if (requested > 0 && fcntl(fd, F_SETPIPE_SZ, static_cast<int>(requested)) < 0) {
+            // Unprivileged callers are capped by /proc/sys/fs/pipe-max-size.
+            std::ifstream max_file("/proc/sys/fs/pipe-max-size");
+            u64 max_size = 0;
+            if (max_file >> max_size && max_size > 0 && max_size < requested) {
+                fcntl(fd, F_SETPIPE_SZ, static_cast<int>(max_size));
+            }
+        }
+        int capacity = fcntl(fd, F_GETPIPE_SZ);
+        return capacity > 0 ? static_cast<u64>(capacity) : 0;
+    }
+
+    // Empties the pipe into m_buffer regardless of how far behind the
+    // consumer is, so the engine never waits on us.
+    void drain() {
+        VGCE_TRACE_SCOPE("pipe.drain");
+        auto now = std::chrono::steady_clock::now();
+        u64 woke_ns = metrics::monotonic_ns();
+        int available = 0;
+        if (ioctl(m_engine_stdout_read_fd, FIONREAD, &available) == 0 && available > 0) {
+            u64 fill = static_cast<u64>(available);
+            if (fill > m_pipe->peak_fill.load(std::memory_order_relaxed)) {
+                m_pipe->peak_fill.store(fill, std::memory_order_relaxed);
+            }
+            u64 capacity = m_pipe->capacity.load(std::memory_order_relaxed);
+            if (capacity > 0 && fill >= capacity) {
+                auto window = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  now - m_last_drain_time).count();
+                m_pipe->full_events.fetch_add(1, std::memory_order_relaxed);
+                m_pipe->stall_bound_total_ns.fetch_add(static_cast<u64>(window),
+                                                    std::memory_order_relaxed);
+            }
+        }
+
+        int mirror_fd = m_mirror_fd.load(std::memory_order_acquire);
+        char chunk[READ_CHUNK_SIZE];
+        while (true) {
+            // A mirror that is a pipe gets the bytes by tee before we consume
+            // them; anything else (full pipe, tty, file) gets a plain write.
+            ssize_t teed = -1;
+            if (mirror_fd >= 0 && m_mirror_is_pipe) {
+                teed = tee(m_engine_stdout_read_fd, mirror_fd, sizeof(chunk), SPLICE_F_NONBLOCK);
+                if (teed < 0 && errno == EINVAL) {
+                    m_mirror_is_pipe = false;
+                }
+            }
+            ssize_t bytes_read = read(m_engine_stdout_read_fd, chunk,
+                                      teed > 0 ? static_cast<u64>(teed) : sizeof(chunk));
+            if (bytes_read <= 0) {
+                break;
+            }
+            if (mirror_fd >= 0) {
+                if (teed <= 0 && !write_all(mirror_fd, chunk, static_cast<u64>(bytes_read))) {
+                    // The reader is gone; keep parsing for the viewer.
+                    m_mirror_fd.store(-1, std::memory_order_relaxed);
+                    mirror_fd = -1;
+                } else if (auto* latency = m_mirror_latency.load(std::memory_order_relaxed)) {
+                    latency->record(metrics::monotonic_ns() - woke_ns);
+                }
+            }
+            m_buffer.append(chunk, static_cast<u64>(bytes_read));
+            m_pipe->bytes_read.fetch_add(static_cast<u64>(bytes_read), std::memory_order_relaxed);
+        }
+        m_last_drain_time = now;
+
+        u64 spill = m_buffer.size() - m_read_pos;
+        m_pipe->spill_bytes.store(spill, std::memory_order_relaxed);
+        if (spill > m_pipe->peak_spill_bytes.load(std::memory_order_relaxed)) {
+            m_pipe->peak_spill_bytes.store(spill, std::memory_order_relaxed);
+        }
+    }
+
+    std::optional<Line> extract_line() {
+        VGCE_TRACE_SCOPE("read_line");
+        auto pos = m_buffer.find('\n', m_read_pos);
+        if (pos == std::string::npos) {
+            return std::nullopt;
+        }
+        Line line{m_buffer.substr(m_read_pos, pos - m_read_pos), metrics::monotonic_ns()};
+        m_read_pos = pos + 1;
+        // Compact lazily so consuming a large spill stays linear.
+        if (m_read_pos == m_buffer.size()) {
+            m_buffer.clear();
+            m_read_pos = 0;
+        } else if (m_read_pos > COMPACT_THRESHOLD && m_read_pos * 2 > m_buffer.size()) {
+            m_buffer.erase(0, m_read_pos);
+            m_read_pos = 0;
+        }
+        return line;
+    }
+
+    void spawn_with_posix_spawn(const std::filesystem::path& executable,
+                                const std::vector<char*>& c_args, const Placement& placement) {
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, m_engine_stdin_pipe[0], STDIN_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, m_engine_stdout_pipe[1], STDOUT_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, m_engine_stdout_pipe[1], STDERR_FILENO);
+        posix_spawn_file_actions_addclose(&actions, m_engine_stdin_pipe[0]);
+        posix_spawn_file_actions_addclose(&actions, m_engine_stdin_pipe[1]);
+        posix_spawn_file_actions_addclose(&actions, m_engine_stdout_pipe[0]);
+        posix_spawn_file_actions_addclose(&actions, m_engine_stdout_pipe[1]);
+
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+        if (placement.policy != SchedPolicy::Default) {
+            sched_param param{};
+            if (placement.policy == SchedPolicy::Fifo ||
+                placement.policy == SchedPolicy::RoundRobin) {
+                param.sched_priority = placement.rt_priority;
+            }
+            posix_spawnattr_setschedpolicy(&attr, to_native_policy(placement.policy));
+            posix_spawnattr_setschedparam(&attr, &param);
+            posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSCHEDULER);
+        }
+
+        // CPU mask, nice value and memory policy are inherited from the
+        // spawning thread, so borrow them for the duration of the spawn.
+        cpu_set_t saved_affinity;
+        CPU_ZERO(&saved_affinity);
+        bool restore_affinity = sched_getaffinity(0, sizeof(cpu_set_t), &saved_affinity) == 0;
+        cpu_set_t child_affinity =
+            placement.cpus.empty() ? g_inherited_placement.affinity : to_cpu_set(placement.cpus);
+        sched_setaffinity(0, sizeof(cpu_set_t), &child_affinity);
+        errno = 0;
+        int saved_nice = getpriority(PRIO_PROCESS, 0);
+        bool restore_nice = errno == 0 && saved_nice != g_inherited_placement.nice;
+        if (restore_nice) {
+            setpriority(PRIO_PROCESS, 0, g_inherited_placement.nice);
+        }
+        int saved_mode = MPOL_DEFAULT_MODE;
+        unsigned long saved_nodes = 0;
+        if (placement.numa_node) {
+            syscall(SYS_get_mempolicy, &saved_mode, &saved_nodes, MAX_NUMA_NODES + 1, nullptr, 0);
+        }
+        Placement memory_only;
+        memory_only.numa_node = placement.numa_node;
+        apply_placement(memory_only, nullptr);
+
+        int result = posix_spawnp(&m_pid, executable.c_str(), &actions, &attr, c_args.data(),
+                                  environ);
+
+        if (placement.numa_node) {
+            syscall(SYS_set_mempolicy, saved_mode, &saved_nodes, MAX_NUMA_NODES + 1);
+        }
+        if (restore_nice) {
+            setpriority(PRIO_PROCESS, 0, saved_nice);
+        }
+        if (restore_affinity) {
+            sched_setaffinity(0, sizeof(cpu_set_t), &saved_affinity);
+        }
+        posix_spawnattr_destroy(&attr);
+        posix_spawn_file_actions_destroy(&actions);
+
+        if (result != 0) {
+            m_pid = -1;
+            throw std::runtime_error("Failed to launch engine: " + std::string(strerror(result)));
+        }
+    }
+
+    void spawn_with_fork(const std::filesystem::path& executable,
+                         const std::vector<char*>& c_args, const Placement& placement) {
+        cpu_set_t cpu_set = to_cpu_set(placement.cpus);
+        const cpu_set_t* cpu_set_ptr = placement.cpus.empty() ? nullptr : &cpu_set;
+
+        m_pid = fork();
+        if (m_pid < 0) {
+            throw std::runtime_error("Fork failed");
+        }
+
+        if (m_pid == 0) {
+            dup2(m_engine_stdin_pipe[0], STDIN_FILENO);
+            dup2(m_engine_stdout_pipe[1], STDOUT_FILENO);
+            dup2(m_engine_stdout_pipe[1], STDERR_FILENO);
+
+            close(m_engine_stdin_pipe[0]);
+            close(m_engine_stdin_pipe[1]);
+            close(m_engine_stdout_pipe[0]);
+            close(m_engine_stdout_pipe[1]);
+
+            sched_setaffinity(0, sizeof(cpu_set_t), &g_inherited_placement.affinity);
+            setpriority(PRIO_PROCESS, 0, g_inherited_placement.nice);
+            if (!apply_placement(placement, cpu_set_ptr)) {
+                perror("vgce: engine placement");
+            }
+
+            execvp(executable.c_str(), c_args.data());
+            perror("execvp");
+            _exit(1);
+        }
+    }
+
     pid_t m_pid{-1};
     int m_engine_stdin_pipe[2]{};
     int m_engine_stdout_pipe[2]{};
     int m_engine_stdin_write_fd{-1};
     int m_engine_stdout_read_fd{-1};
     std::string m_buffer;
+    u64 m_read_pos = 0;
+    std::chrono::steady_clock::time_point m_last_drain_time = std::chrono::steady_clock::now();
+    std::atomic<int> m_mirror_fd{-1};
+    std::atomic<metrics::LatencyHistogram*> m_mirror_latency{nullptr};
+    // Cleared the first time tee() reports a descriptor that is not a pipe.
+    bool m_mirror_is_pipe = true;
+    bool m_input_is_pipe = true;
+
+    std::shared_ptr<PipeCounters> m_pipe = std::make_shared<PipeCounters>();
 };
 
 Process::Process(const std::filesystem::path& executable,
-                 const std::vector<std::string>& args)
-        : p_impl(std::make_unique<ProcessImpl>(executable, args)) {}
+                 const std::vector<std::string>& args, const Placement& placement,
+                 u64 pipe_size)
+        : p_impl(std::make_unique<ProcessImpl>(executable, args, placement, pipe_size)) {}
 Process::~Process() = default;
 Process::Process(Process&&) noexcept = default;
 Process& Process::operator=(Process&&) noexcept = default;
 
 bool Process::is_running() const { return p_impl->is_running(); }
+i64 Process::pid() const { return p_impl->pid(); }
 bool Process::write_line(std::string_view line) { return p_impl->write_line(line); }
 void Process::terminate() { p_impl->terminate(); }
 
-std::optional<std::string> Process::read_line() { return p_impl->read_line(); }
+std::optional<Line> Process::read_line() { return p_impl->read_line(); }
+PipeStats Process::pipe_stats() const { return p_impl->pipe_counters()->snapshot(); }
+
+std::shared_ptr<const PipeCounters> Process::share_pipe_counters() const {
+    return p_impl->pipe_counters();
+}
+
+void Process::mirror_output(i32 fd, metrics::LatencyHistogram* forward_latency) {
+    p_impl->mirror_output(fd, forward_latency);
+}
+
+i64 Process::forward_input(i32 fd, std::string& copy, metrics::LatencyHistogram* forward_latency) {
+    return p_impl->forward_input(fd, copy, forward_latency);
+}
+
+ConsoleStreams detach_console(const std::filesystem::path& terminal) {
+    const char* target_path = terminal.empty() ? "/dev/null" : terminal.c_str();
+    int target = open(target_path, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (target < 0) {
+        throw std::runtime_error("Cannot open '" + std::string(target_path) + "': " + std::strerror(errno));
+    }
+    ConsoleStreams streams;
+    streams.input = fcntl(STDIN_FILENO, F_DUPFD_CLOEXEC, 3);
+    streams.output = fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 3);
+    if (streams.input < 0 || streams.output < 0 || dup2(target, STDIN_FILENO) < 0 ||
+        dup2(target, STDOUT_FILENO) < 0) {
+        int error = errno;
+        close(target);
+        throw std::runtime_error("Cannot detach the console: " + std::string(std::strerror(error)));
+    }
+    close(target);
+    // A GUI that hangs up must not take vgce down before it can stop the engine.
+    signal(SIGPIPE, SIG_IGN);
+    return streams;
+}
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open '" + path.string() + "': " + std::strerror(errno));
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        int error = errno;
+        close(fd);
+        throw std::runtime_error("Cannot stat '" + path.string() + "': " + std::strerror(error));
+    }
+    m_size = static_cast<u64>(info.st_size);
+    if (m_size > 0) {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            int error = errno;
+            close(fd);
+            throw std::runtime_error("Cannot map '" + path.string() + "': " + std::strerror(error));
+        }
+        m_data = static_cast<u8*>(data);
+    }
+    close(fd);
+}
+
+MappedFile::MappedFile(const std::filesystem::path& path, u64 size) : m_writable(true) {
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open '" + path.string() + "': " + std::strerror(errno));
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 ||
+        (static_cast<u64>(info.st_size) < size && ftruncate(fd, static_cast<off_t>(size)) != 0)) {
+        int error = errno;
+        close(fd);
+        throw std::runtime_error("Cannot size '" + path.string() + "': " + std::strerror(error));
+    }
+    m_size = std::max(size, static_cast<u64>(info.st_size));
+    void* data = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int error = errno;
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Cannot map '" + path.string() + "': " + std::strerror(error));
+    }
+    m_data = static_cast<u8*>(data);
+}
+
+MappedFile::~MappedFile() {
+    if (m_data) {
+        munmap(m_data, m_size);
+    }
+}
+
+void MappedFile::flush() {
+    if (m_data && m_writable) {
+        msync(m_data, m_size, MS_ASYNC);
+    }
+}
+
+SharedMemory::SharedMemory(const std::string& name) : m_name(name.starts_with('/') ? name : "/" + name) {
+    int fd = shm_open(m_name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open shared memory '" + name + "': " + std::strerror(errno));
+    }
+    struct stat info {};
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        m_size = static_cast<u64>(info.st_size);
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        m_data = data == MAP_FAILED ? nullptr : static_cast<u8*>(data);
+    }
+    close(fd);
+    if (!m_data) {
+        throw std::runtime_error("Cannot map shared memory '" + name + "'");
+    }
+}
+
+SharedMemory::SharedMemory(const std::string& name, u64 size)
+        : m_size(size), m_is_owner(true), m_name(name.starts_with('/') ? name : "/" + name) {
+    int fd = shm_open(m_name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create shared memory '" + name + "': " + std::strerror(errno));
+    }
+    // Truncating first zeroes whatever a stale object held.
+    void* data = MAP_FAILED;
+    if (ftruncate(fd, 0) == 0 && ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    int error = errno;
+    close(fd);
+    if (data == MAP_FAILED) {
+        shm_unlink(m_name.c_str());
+        throw std::runtime_error("Cannot map shared memory '" + name + "': " + std::strerror(error));
+    }
+    m_data = static_cast<u8*>(data);
+}
+
+SharedMemory::~SharedMemory() {
+    if (m_data) {
+        munmap(m_data, m_size);
+    }
+    if (m_is_owner) {
+        shm_unlink(m_name.c_str());
+    }
+}
+
+LocalSocket LocalSocket::listen(const std::filesystem::path& path) {
+    auto address = socket_address(path);
+    std::error_code error;
+    if (std::filesystem::is_socket(path, error)) {
+        bool in_use = false;
+        try {
+            in_use = connect(path).is_open();
+        } catch (const std::exception&) {
+            // Left behind by a server that did not exit cleanly.
+        }
+        if (in_use) {
+            throw std::runtime_error("Another server is listening on '" + path.string() + "'");
+        }
+        std::filesystem::remove(path, error);
+    }
+
+    LocalSocket socket(::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+    if (!socket.is_open() ||
+        bind(static_cast<int>(socket.m_handle), reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(static_cast<int>(socket.m_handle), SOMAXCONN) != 0) {
+        throw std::runtime_error("Cannot listen on '" + path.string() + "': " + std::strerror(errno));
+    }
+    socket.m_path = path;
+    return socket;
+}
+
+LocalSocket LocalSocket::listen_loopback(u16 port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int reuse = 1;
+    LocalSocket socket(::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+    if (!socket.is_open() ||
+        setsockopt(static_cast<int>(socket.m_handle), SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+        bind(static_cast<int>(socket.m_handle), reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(static_cast<int>(socket.m_handle), SOMAXCONN) != 0) {
+        throw std::runtime_error("Cannot listen on port " + std::to_string(port) + ": " + std::strerror(errno));
+    }
+    return socket;
+}
+
+LocalSocket LocalSocket::connect(const std::filesystem::path& path) {
+    auto address = socket_address(path);
+    LocalSocket socket(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    if (!socket.is_open() ||
+        ::connect(static_cast<int>(socket.m_handle), reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        throw std::runtime_error("Cannot connect to '" + path.string() + "': " + std::strerror(errno));
+    }
+    return socket;
+}
+
+LocalSocket::~LocalSocket() {
+    close();
+}
+
+LocalSocket::LocalSocket(LocalSocket&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, INVALID_HANDLE)), m_path(std::move(other.m_path)) {
+    other.m_path.clear();
+}
+
+LocalSocket& LocalSocket::operator=(LocalSocket&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_handle = std::exchange(other.m_handle, INVALID_HANDLE);
+        m_path = std::move(other.m_path);
+        other.m_path.clear();
+    }
+    return *this;
+}
+
+void LocalSocket::close() {
+    if (is_open()) {
+        ::close(static_cast<int>(m_handle));
+        m_handle = INVALID_HANDLE;
+    }
+    if (!m_path.empty()) {
+        std::error_code error;
+        std::filesystem::remove(m_path, error);
+        m_path.clear();
+    }
+}
+
+std::optional<LocalSocket> LocalSocket::accept() {
+    int peer = accept4(static_cast<int>(m_handle), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (peer < 0) {
+        return std::nullopt;
+    }
+    return LocalSocket(peer);
+}
+
+i64 LocalSocket::send_some(std::span<const u8> bytes) {
+    ssize_t sent = send(static_cast<int>(m_handle), bytes.data(), bytes.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+    }
+    return sent;
+}
+
+i64 LocalSocket::receive(std::span<u8> buffer, std::chrono::milliseconds timeout) {
+    struct pollfd pfd = {static_cast<int>(m_handle), POLLIN, 0};
+    if (poll(&pfd, 1, static_cast<int>(timeout.count())) <= 0) {
+        return 0;
+    }
+    ssize_t received = recv(static_cast<int>(m_handle), buffer.data(), buffer.size(), MSG_DONTWAIT);
+    if (received < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+    }
+    return received > 0 ? received : -1;
+}
 
 } // namespace vgce::process
@@ -1,15 +1,189 @@
 #include "process/process.hpp"
+#include "metrics/clock.hpp"
+#include "metrics/latency_histogram.hpp"
+#include "metrics/trace.hpp"
+#include "process/local_socket.hpp"
+#include "process/mapped_file.hpp"
+#include "process/shared_memory.hpp"
+#include "process/resource_usage.hpp"
+#include <winsock2.h>
+#include <afunix.h>
 #include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#include <psapi.h>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace vgce::process {
 
+namespace {
+
+constexpr DWORD INPUT_POLL_INTERVAL_MS = 5;
+
+constexpr u32 MAX_MASK_CPUS = sizeof(DWORD_PTR) * 8;
+
+// Winsock needs starting once per process before the first socket.
+void start_winsock() {
+    static const bool started = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    if (!started) {
+        throw std::runtime_error("Winsock is unavailable");
+    }
+}
+
+sockaddr_un socket_address(const std::filesystem::path& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::string text = path.string();
+    if (text.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path too long: '" + text + "'");
+    }
+    std::memcpy(address.sun_path, text.data(), text.size());
+    return address;
+}
+
+bool is_transient(int error) {
+    return error == WSAEWOULDBLOCK || error == WSAEINTR;
+}
+
+DWORD_PTR to_affinity_mask(const std::vector<u32>& cpus) {
+    DWORD_PTR mask = 0;
+    for (u32 cpu : cpus) {
+        if (cpu < MAX_MASK_CPUS) {
+            mask |= static_cast<DWORD_PTR>(1) << cpu;
+        }
+    }
+    return mask;
+}
+
+DWORD to_priority_class(i32 nice) {
+    if (nice >= 15) {
+        return IDLE_PRIORITY_CLASS;
+    }
+    if (nice > 0) {
+        return BELOW_NORMAL_PRIORITY_CLASS;
+    }
+    if (nice <= -15) {
+        return HIGH_PRIORITY_CLASS;
+    }
+    if (nice < 0) {
+        return ABOVE_NORMAL_PRIORITY_CLASS;
+    }
+    return NORMAL_PRIORITY_CLASS;
+}
+
+int to_thread_priority(i32 nice) {
+    if (nice >= 15) {
+        return THREAD_PRIORITY_IDLE;
+    }
+    if (nice > 0) {
+        return THREAD_PRIORITY_BELOW_NORMAL;
+    }
+    if (nice < 0) {
+        return THREAD_PRIORITY_ABOVE_NORMAL;
+    }
+    return THREAD_PRIORITY_NORMAL;
+}
+
+} // namespace
+
+i64 current_process_id() {
+    return static_cast<i64>(GetCurrentProcessId());
+}
+
+u32 online_cpu_count() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<u32>(info.dwNumberOfProcessors);
+}
+
+std::optional<ResourceUsage> read_resource_usage(i64 pid) {
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+    if (!process) {
+        return std::nullopt;
+    }
+    ResourceUsage usage;
+    FILETIME creation, exit, kernel, user;
+    if (GetProcessTimes(process, &creation, &exit, &kernel, &user)) {
+        auto to_u64 = [](FILETIME ft) {
+            return (static_cast<u64>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+        };
+        // FILETIME counts 100ns intervals.
+        usage.cpu_time_ns = (to_u64(kernel) + to_u64(user)) * 100;
+    }
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (K32GetProcessMemoryInfo(process, &counters, sizeof(counters))) {
+        usage.rss_bytes = counters.WorkingSetSize;
+    }
+    CloseHandle(process);
+    return usage;
+}
+
+u32 numa_node_count() {
+    ULONG highest = 0;
+    if (!GetNumaHighestNodeNumber(&highest)) {
+        return 1;
+    }
+    return static_cast<u32>(highest) + 1;
+}
+
+std::vector<u32> numa_node_cpus(u32 node) {
+    ULONGLONG mask = 0;
+    std::vector<u32> cpus;
+    if (!GetNumaNodeProcessorMask(static_cast<UCHAR>(node), &mask)) {
+        return cpus;
+    }
+    for (u32 cpu = 0; cpu < 64; ++cpu) {
+        if (mask & (1ULL << cpu)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+u32 next_numa_node() {
+    static std::atomic<u32> next{0};
+    return next.fetch_add(1) % numa_node_count();
+}
+
+Placement resolve_placement(const Placement& placement) {
+    Placement resolved = placement;
+    if (resolved.auto_numa && !resolved.numa_node && numa_node_count() > 1) {
+        resolved.numa_node = next_numa_node();
+    }
+    if (resolved.numa_node && resolved.cpus.empty()) {
+        resolved.cpus = numa_node_cpus(*resolved.numa_node);
+    }
+    return resolved;
+}
+
+bool apply_to_current_thread(const Placement& placement) {
+    Placement resolved = resolve_placement(placement);
+    bool ok = true;
+    if (!resolved.cpus.empty() &&
+        SetThreadAffinityMask(GetCurrentThread(), to_affinity_mask(resolved.cpus)) == 0) {
+        ok = false;
+    }
+    if (resolved.nice && !SetThreadPriority(GetCurrentThread(), to_thread_priority(*resolved.nice))) {
+        ok = false;
+    }
+    return ok;
+}
+
 class Process::ProcessImpl {
 public:
-    ProcessImpl(const std::filesystem::path& executable,
-                const std::vector<std::string>& args) {
+    ProcessImpl(const std::filesystem::path& executable, const std::vector<std::string>& args,
+                const Placement& placement, u64 pipe_size) {
+        Placement resolved = resolve_placement(placement);
         SECURITY_ATTRIBUTES sa_attr;
         sa_attr.nLength = sizeof(SECURITY_ATTRIBUTES);
         sa_attr.bInheritHandle = TRUE;
@@ -22,12 +196,14 @@ public:
             throw std::runtime_error("Failed to set handle information for stdin");
         }
 
-        if (!CreatePipe(&m_engine_stdout_read, &m_engine_stdout_write, &sa_attr, 0)) {
+        if (!CreatePipe(&m_engine_stdout_read, &m_engine_stdout_write, &sa_attr,
+                        static_cast<DWORD>(pipe_size))) {
             throw std::runtime_error("Failed to create engine stdout pipe");
         }
         if (!SetHandleInformation(m_engine_stdout_read, HANDLE_FLAG_INHERIT, 0)) {
             throw std::runtime_error("Failed to set handle information for stdout");
         }
+        m_pipe->capacity.store(pipe_size);
 
         STARTUPINFOW si_startup_info{};
         si_startup_info.cb = sizeof(STARTUPINFOW);
@@ -42,10 +218,18 @@ public:
         }
         std::wstring w_command_line(command_line.begin(), command_line.end());
 
-        if (!CreateProcessW(nullptr, &w_command_line[0], nullptr, nullptr, TRUE, 0,
+        DWORD creation_flags = CREATE_SUSPENDED;
+        if (resolved.nice) {
+            creation_flags |= to_priority_class(*resolved.nice);
+        }
+        if (!CreateProcessW(nullptr, &w_command_line[0], nullptr, nullptr, TRUE, creation_flags,
                             nullptr, nullptr, &si_startup_info, &m_process_info)) {
             throw std::runtime_error("Failed to create process");
         }
+        if (!resolved.cpus.empty()) {
+            SetProcessAffinityMask(m_process_info.hProcess, to_affinity_mask(resolved.cpus));
+        }
+        ResumeThread(m_process_info.hThread);
 
         CloseHandle(m_engine_stdin_read);
         CloseHandle(m_engine_stdout_write);
@@ -59,6 +243,10 @@ public:
         CloseHandle(m_engine_stdout_read);
     }
 
+    i64 pid() const {
+        return static_cast<i64>(m_process_info.dwProcessId);
+    }
+
     bool is_running() const {
         if (!m_is_running) {
             return false;
@@ -75,27 +263,85 @@ public:
                          static_cast<DWORD>(full_line.length()), &bytes_written, nullptr);
     }
 
-    std::optional<std::string> read_line() {
+    std::optional<Line> read_line() {
+        DWORD available = 0;
+        if (PeekNamedPipe(m_engine_stdout_read, nullptr, 0, nullptr, &available, nullptr)) {
+            if (available > m_pipe->peak_fill.load(std::memory_order_relaxed)) {
+                m_pipe->peak_fill.store(available, std::memory_order_relaxed);
+            }
+            u64 capacity = m_pipe->capacity.load(std::memory_order_relaxed);
+            if (capacity > 0 && available >= capacity) {
+                m_pipe->full_events.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
         char buffer[4096];
         DWORD bytes_read;
         if (ReadFile(m_engine_stdout_read, buffer, sizeof(buffer) - 1, &bytes_read,
                      nullptr) &&
             bytes_read > 0) {
+            u64 read_ns = metrics::monotonic_ns();
+            if (HANDLE mirror = m_mirror.load(std::memory_order_acquire)) {
+                DWORD written;
+                if (!WriteFile(mirror, buffer, bytes_read, &written, nullptr)) {
+                    m_mirror.store(nullptr, std::memory_order_relaxed);
+                } else if (auto* latency = m_mirror_latency.load(std::memory_order_relaxed)) {
+                    latency->record(metrics::monotonic_ns() - read_ns);
+                }
+            }
             buffer[bytes_read] = '\0';
             m_buffer += buffer;
+            m_pipe->bytes_read.fetch_add(bytes_read, std::memory_order_relaxed);
         }
 
+        VGCE_TRACE_SCOPE("read_line");
         if (auto pos = m_buffer.find('\n'); pos != std::string::npos) {
-            std::string line = m_buffer.substr(0, pos);
+            Line line{m_buffer.substr(0, pos), metrics::monotonic_ns()};
             m_buffer.erase(0, pos + 1);
-            if (!line.empty() && line.back() == '\r') {
-                line.pop_back();
+            if (!line.text.empty() && line.text.back() == '\r') {
+                line.text.pop_back();
             }
             return line;
         }
         return std::nullopt;
     }
 
+    const std::shared_ptr<PipeCounters>& pipe_counters() const { return m_pipe; }
+
+    void mirror_output(i32 fd, metrics::LatencyHistogram* forward_latency) {
+        m_mirror_latency.store(forward_latency, std::memory_order_relaxed);
+        m_mirror.store(reinterpret_cast<HANDLE>(_get_osfhandle(fd)), std::memory_order_release);
+    }
+
+    // Anonymous pipes cannot be waited on, so an idle pipe is polled.
+    i64 forward_input(i32 fd, std::string& copy, metrics::LatencyHistogram* forward_latency) {
+        HANDLE input = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+        DWORD available = 0;
+        if (PeekNamedPipe(input, nullptr, 0, nullptr, &available, nullptr)) {
+            if (available == 0) {
+                Sleep(INPUT_POLL_INTERVAL_MS);
+                return 0;
+            }
+        } else if (GetLastError() == ERROR_BROKEN_PIPE) {
+            return -1;
+        } else if (WaitForSingleObject(input, INPUT_POLL_INTERVAL_MS) != WAIT_OBJECT_0) {
+            return 0;
+        }
+        u64 woke_ns = metrics::monotonic_ns();
+        char buffer[4096];
+        DWORD bytes_read = 0;
+        DWORD written = 0;
+        if (!ReadFile(input, buffer, sizeof(buffer), &bytes_read, nullptr) || bytes_read == 0 ||
+            !WriteFile(m_engine_stdin_write, buffer, bytes_read, &written, nullptr)) {
+            return -1;
+        }
+        if (forward_latency) {
+            forward_latency->record(metrics::monotonic_ns() - woke_ns);
+        }
+        copy.append(buffer, bytes_read);
+        return bytes_read;
+    }
+
     void terminate() {
         if (m_is_running) {
             TerminateProcess(m_process_info.hProcess, 0);
@@ -111,19 +357,294 @@ private:
     HANDLE m_engine_stdout_read{nullptr}, m_engine_stdout_write{nullptr};
     std::string m_buffer;
     bool m_is_running{true};
+    std::atomic<HANDLE> m_mirror{nullptr};
+    std::atomic<metrics::LatencyHistogram*> m_mirror_latency{nullptr};
+
+    std::shared_ptr<PipeCounters> m_pipe = std::make_shared<PipeCounters>();
 };
 
 Process::Process(const std::filesystem::path& executable,
-                 const std::vector<std::string>& args)
-        : p_impl(std::make_unique<ProcessImpl>(executable, args)) {}
+                 const std::vector<std::string>& args, const Placement& placement,
+                 u64 pipe_size)
+        : p_impl(std::make_unique<ProcessImpl>(executable, args, placement, pipe_size)) {}
 Process::~Process() = default;
 Process::Process(Process&&) noexcept = default;
 Process& Process::operator=(Process&&) noexcept = default;
 
 bool Process::is_running() const { return p_impl->is_running(); }
+i64 Process::pid() const { return p_impl->pid(); }
 bool Process::write_line(std::string_view line) { return p_impl->write_line(line); }
 void Process::terminate() { p_impl->terminate(); }
 
-std::optional<std::string> Process::read_line() { return p_impl->read_line(); }
+std::optional<Line> Process::read_line() { return p_impl->read_line(); }
+PipeStats Process::pipe_stats() const { return p_impl->pipe_counters()->snapshot(); }
+
+std::shared_ptr<const PipeCounters> Process::share_pipe_counters() const {
+    return p_impl->pipe_counters();
+}
+
+void Process::mirror_output(i32 fd, metrics::LatencyHistogram* forward_latency) {
+    p_impl->mirror_output(fd, forward_latency);
+}
+
+i64 Process::forward_input(i32 fd, std::string& copy, metrics::LatencyHistogram* forward_latency) {
+    return p_impl->forward_input(fd, copy, forward_latency);
+}
+
+ConsoleStreams detach_console(const std::filesystem::path& terminal) {
+    std::string target_path = terminal.empty() ? "NUL" : terminal.string();
+    int target = _open(target_path.c_str(), _O_RDWR | _O_BINARY);
+    if (target < 0) {
+        throw std::runtime_error("Cannot open '" + target_path + "'");
+    }
+    ConsoleStreams streams;
+    streams.input = _dup(0);
+    streams.output = _dup(1);
+    if (streams.input < 0 || streams.output < 0 || _dup2(target, 0) < 0 || _dup2(target, 1) < 0) {
+        _close(target);
+        throw std::runtime_error("Cannot detach the console");
+    }
+    _close(target);
+    _setmode(streams.input, _O_BINARY);
+    _setmode(streams.output, _O_BINARY);
+    return streams;
+}
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open '" + path.string() + "'");
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw std::runtime_error("Cannot read the size of '" + path.string() + "'");
+    }
+    m_size = static_cast<u64>(size.QuadPart);
+    if (m_size > 0) {
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!data) {
+            if (mapping) {
+                CloseHandle(mapping);
+            }
+            CloseHandle(file);
+            throw std::runtime_error("Cannot map '" + path.string() + "'");
+        }
+        m_handle = mapping;
+        m_data = static_cast<u8*>(data);
+    }
+    CloseHandle(file);
+}
+
+MappedFile::MappedFile(const std::filesystem::path& path, u64 size) : m_writable(true) {
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open '" + path.string() + "'");
+    }
+    LARGE_INTEGER current;
+    if (!GetFileSizeEx(file, &current)) {
+        CloseHandle(file);
+        throw std::runtime_error("Cannot read the size of '" + path.string() + "'");
+    }
+    // Mapping past the end extends the file with zeroes.
+    m_size = std::max(size, static_cast<u64>(current.QuadPart));
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(m_size >> 32),
+                                        static_cast<DWORD>(m_size & 0xFFFFFFFF), nullptr);
+    void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0) : nullptr;
+    CloseHandle(file);
+    if (!data) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        throw std::runtime_error("Cannot map '" + path.string() + "'");
+    }
+    m_handle = mapping;
+    m_data = static_cast<u8*>(data);
+}
+
+MappedFile::~MappedFile() {
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+        CloseHandle(static_cast<HANDLE>(m_handle));
+    }
+}
+
+void MappedFile::flush() {
+    if (m_data && m_writable) {
+        FlushViewOfFile(m_data, 0);
+    }
+}
+
+namespace {
+
+// Local\ keeps the name within this login session.
+std::wstring mapping_name(const std::string& name) {
+    std::string full_name = "Local\\" + name;
+    return std::wstring(full_name.begin(), full_name.end());
+}
+
+} // namespace
+
+SharedMemory::SharedMemory(const std::string& name) : m_name(name) {
+    HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, mapping_name(name).c_str());
+    void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!data) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        throw std::runtime_error("Cannot open shared memory '" + name + "'");
+    }
+    MEMORY_BASIC_INFORMATION info{};
+    VirtualQuery(data, &info, sizeof(info));
+    m_handle = mapping;
+    m_data = static_cast<u8*>(data);
+    m_size = static_cast<u64>(info.RegionSize);
+}
+
+// The mapping goes away with its last handle, so nothing is left to remove.
+SharedMemory::SharedMemory(const std::string& name, u64 size) : m_size(size), m_is_owner(true), m_name(name) {
+    HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+                                        static_cast<DWORD>(size & 0xFFFFFFFF), mapping_name(name).c_str());
+    void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0) : nullptr;
+    if (!data) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        throw std::runtime_error("Cannot create shared memory '" + name + "'");
+    }
+    m_handle = mapping;
+    m_data = static_cast<u8*>(data);
+    std::memset(m_data, 0, m_size);
+}
+
+SharedMemory::~SharedMemory() {
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+        CloseHandle(static_cast<HANDLE>(m_handle));
+    }
+}
+
+LocalSocket LocalSocket::listen(const std::filesystem::path& path) {
+    start_winsock();
+    auto address = socket_address(path);
+    std::error_code error;
+    if (std::filesystem::exists(path, error)) {
+        bool in_use = false;
+        try {
+            in_use = connect(path).is_open();
+        } catch (const std::exception&) {
+            // Left behind by a server that did not exit cleanly.
+        }
+        if (in_use) {
+            throw std::runtime_error("Another server is listening on '" + path.string() + "'");
+        }
+        std::filesystem::remove(path, error);
+    }
+
+    LocalSocket socket(static_cast<i64>(::socket(AF_UNIX, SOCK_STREAM, 0)));
+    u_long non_blocking = 1;
+    if (!socket.is_open() ||
+        bind(static_cast<SOCKET>(socket.m_handle), reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(static_cast<SOCKET>(socket.m_handle), SOMAXCONN) != 0 ||
+        ioctlsocket(static_cast<SOCKET>(socket.m_handle), FIONBIO, &non_blocking) != 0) {
+        throw std::runtime_error("Cannot listen on '" + path.string() + "'");
+    }
+    socket.m_path = path;
+    return socket;
+}
+
+LocalSocket LocalSocket::listen_loopback(u16 port) {
+    start_winsock();
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    LocalSocket socket(static_cast<i64>(::socket(AF_INET, SOCK_STREAM, 0)));
+    u_long non_blocking = 1;
+    if (!socket.is_open() ||
+        bind(static_cast<SOCKET>(socket.m_handle), reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(static_cast<SOCKET>(socket.m_handle), SOMAXCONN) != 0 ||
+        ioctlsocket(static_cast<SOCKET>(socket.m_handle), FIONBIO, &non_blocking) != 0) {
+        throw std::runtime_error("Cannot listen on port " + std::to_string(port));
+    }
+    return socket;
+}
+
+LocalSocket LocalSocket::connect(const std::filesystem::path& path) {
+    start_winsock();
+    auto address = socket_address(path);
+    LocalSocket socket(static_cast<i64>(::socket(AF_UNIX, SOCK_STREAM, 0)));
+    if (!socket.is_open() ||
+        ::connect(static_cast<SOCKET>(socket.m_handle), reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        throw std::runtime_error("Cannot connect to '" + path.string() + "'");
+    }
+    return socket;
+}
+
+LocalSocket::~LocalSocket() {
+    close();
+}
+
+LocalSocket::LocalSocket(LocalSocket&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, INVALID_HANDLE)), m_path(std::move(other.m_path)) {
+    other.m_path.clear();
+}
+
+LocalSocket& LocalSocket::operator=(LocalSocket&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_handle = std::exchange(other.m_handle, INVALID_HANDLE);
+        m_path = std::move(other.m_path);
+        other.m_path.clear();
+    }
+    return *this;
+}
+
+void LocalSocket::close() {
+    if (is_open()) {
+        closesocket(static_cast<SOCKET>(m_handle));
+        m_handle = INVALID_HANDLE;
+    }
+    if (!m_path.empty()) {
+        std::error_code error;
+        std::filesystem::remove(m_path, error);
+        m_path.clear();
+    }
+}
+
+std::optional<LocalSocket> LocalSocket::accept() {
+    SOCKET peer = ::accept(static_cast<SOCKET>(m_handle), nullptr, nullptr);
+    if (peer == INVALID_SOCKET) {
+        return std::nullopt;
+    }
+    u_long non_blocking = 1;
+    ioctlsocket(peer, FIONBIO, &non_blocking);
+    return LocalSocket(static_cast<i64>(peer));
+}
+
+i64 LocalSocket::send_some(std::span<const u8> bytes) {
+    int length = static_cast<int>(std::min<u64>(bytes.size(), INT_MAX));
+    int sent = send(static_cast<SOCKET>(m_handle), reinterpret_cast<const char*>(bytes.data()), length, 0);
+    if (sent == SOCKET_ERROR) {
+        return is_transient(WSAGetLastError()) ? 0 : -1;
+    }
+    return sent;
+}
+
+i64 LocalSocket::receive(std::span<u8> buffer, std::chrono::milliseconds timeout) {
+    WSAPOLLFD pfd = {static_cast<SOCKET>(m_handle), POLLRDNORM, 0};
+    if (WSAPoll(&pfd, 1, static_cast<INT>(timeout.count())) <= 0) {
+        return 0;
+    }
+    int length = static_cast<int>(std::min<u64>(buffer.size(), INT_MAX));
+    int received = recv(static_cast<SOCKET>(m_handle), reinterpret_cast<char*>(buffer.data()), length, 0);
+    if (received == SOCKET_ERROR) {
+        return is_transient(WSAGetLastError()) ? 0 : -1;
+    }
+    return received > 0 ? received : -1;
+}
 
 } // namespace vgce::process
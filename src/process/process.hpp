@@ -1,6 +1,8 @@
 #pragma once
 
+#include "process/placement.hpp"
 #include "types.hpp"
+#include <atomic>
 #include <filesystem>
 #include <memory>
 #include <optional>
@@ -8,11 +10,72 @@
 #include <string_view>
 #include <vector>
 
+namespace vgce::metrics {
+class LatencyHistogram;
+}
+
 namespace vgce::process {
 
+constexpr u64 DEFAULT_PIPE_SIZE = 1 << 20;
+
+// A line of engine output stamped with the metrics::monotonic_ns() time at
+// which it was extracted from the pipe.
+struct Line {
+    std::string text;
+    u64 read_ns = 0;
+};
+
+// Engine stdout pipe health. A full pipe means the engine may have blocked in
+// write(); stall_bound_total_ns adds up every such window we could not rule
+// out, so it bounds the total time the engine spent blocked.
+struct PipeStats {
+    u64 capacity = 0;
+    u64 bytes_read = 0;
+    u64 peak_fill = 0;
+    u64 full_events = 0;
+    u64 stall_bound_total_ns = 0;
+    u64 spill_bytes = 0;
+    u64 peak_spill_bytes = 0;
+};
+
+// The live counters behind PipeStats, updated by the drain as it reads.
+struct PipeCounters {
+    std::atomic<u64> capacity{0};
+    std::atomic<u64> bytes_read{0};
+    std::atomic<u64> peak_fill{0};
+    std::atomic<u64> full_events{0};
+    std::atomic<u64> stall_bound_total_ns{0};
+    std::atomic<u64> spill_bytes{0};
+    std::atomic<u64> peak_spill_bytes{0};
+
+    PipeStats snapshot() const {
+        PipeStats stats;
+        stats.capacity = capacity.load(std::memory_order_relaxed);
+        stats.bytes_read = bytes_read.load(std::memory_order_relaxed);
+        stats.peak_fill = peak_fill.load(std::memory_order_relaxed);
+        stats.full_events = full_events.load(std::memory_order_relaxed);
+        stats.stall_bound_total_ns = stall_bound_total_ns.load(std::memory_order_relaxed);
+        stats.spill_bytes = spill_bytes.load(std::memory_order_relaxed);
+        stats.peak_spill_bytes = peak_spill_bytes.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
+
+// The standard input and output of a program driving vgce as its engine.
+struct ConsoleStreams {
+    i32 input = -1;
+    i32 output = -1;
+};
+
+// Moves stdin and stdout to new descriptors and reopens them on terminal, or
+// the null device if it is empty, so a UI drawn there stays out of the
+// protocol stream.
+ConsoleStreams detach_console(const std::filesystem::path& terminal);
+
 class Process {
 public:
-    Process(const std::filesystem::path& executable, const std::vector<std::string>& args);
+    Process(const std::filesystem::path& executable, const std::vector<std::string>& args,
+            const Placement& placement = {}, u64 pipe_size = DEFAULT_PIPE_SIZE);
     ~Process();
 
     Process(const Process&) = delete;
@@ -21,9 +84,26 @@ public:
     Process& operator=(Process&&) noexcept;
 
     bool is_running() const;
+    i64 pid() const;
     bool write_line(std::string_view line);
-    std::optional<std::string> read_line();
+    // Drains everything the engine has written and returns the next complete
+    // line, waiting briefly for more output if none is buffered.
+    std::optional<Line> read_line();
     void terminate();
+    PipeStats pipe_stats() const;
+    // For readers that must not wait on whoever owns the Process, and may
+    // outlive it.
+    std::shared_ptr<const PipeCounters> share_pipe_counters() const;
+
+    // Copies the engine's output to fd as it is drained, before it is split
+    // into lines. When fd is a pipe this is tee(2), so the copy never passes
+    // through user space. forward_latency gets the time from the drain waking
+    // to the bytes being handed on.
+    void mirror_output(i32 fd, metrics::LatencyHistogram* forward_latency = nullptr);
+    // Passes whatever is readable on fd to the engine's stdin, waiting briefly
+    // for input, and appends the bytes to copy. Returns the byte count, or -1
+    // once fd is closed.
+    i64 forward_input(i32 fd, std::string& copy, metrics::LatencyHistogram* forward_latency = nullptr);
 
 private:
     class ProcessImpl;
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "types.hpp"
+#include <optional>
+#include <vector>
+
+namespace vgce::process {
+
+struct ThreadUsage {
+    i64 tid = 0;
+    u64 cpu_time_ns = 0;
+    // CPU the thread last ran on.
+    u32 processor = 0;
+};
+
+// Cumulative counters for a whole process, summed over its threads.
+struct ResourceUsage {
+    u64 cpu_time_ns = 0;
+    u64 rss_bytes = 0;
+    u64 voluntary_switches = 0;
+    u64 involuntary_switches = 0;
+    // Time spent runnable but waiting for a CPU.
+    u64 run_delay_ns = 0;
+    std::vector<ThreadUsage> threads;
+};
+
+std::optional<ResourceUsage> read_resource_usage(i64 pid);
+i64 current_process_id();
+u32 online_cpu_count();
+
+} // namespace vgce::process
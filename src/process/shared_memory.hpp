@@ -0,0 +1,37 @@
+#pragma once
+
+#include "types.hpp"
+#include <span>
+#include <string>
+
+namespace vgce::process {
+
+// A named shared-memory object: POSIX shm_open("/<name>"), or a named file
+// mapping Local\<name> on Windows. Throws std::runtime_error if it cannot be
+// created or opened.
+class SharedMemory {
+public:
+    // Maps an existing object read-only.
+    explicit SharedMemory(const std::string& name);
+    // Creates the object, or takes over a stale one, with size zeroed bytes
+    // mapped read-write. It is removed again when this owner is destroyed.
+    SharedMemory(const std::string& name, u64 size);
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    std::span<const u8> bytes() const { return {m_data, m_size}; }
+    // Empty for a read-only mapping.
+    std::span<u8> writable_bytes() const { return m_is_owner ? std::span<u8>{m_data, m_size} : std::span<u8>{}; }
+
+private:
+    u8* m_data = nullptr;
+    u64 m_size = 0;
+    bool m_is_owner = false;
+    std::string m_name;
+    // The mapping object on Windows; unused elsewhere.
+    void* m_handle = nullptr;
+};
+
+} // namespace vgce::process
@@ -0,0 +1,154 @@
+#include "session/analysis_cache.hpp"
+#include "session/session_format.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace vgce::session {
+
+namespace {
+
+constexpr std::array<char, 8> CACHE_MAGIC = {'V', 'G', 'C', 'E', 'C', 'A', 'C', '1'};
+constexpr u32 CACHE_VERSION = 1;
+// Entries looked at from the home slot before the shallowest is replaced.
+constexpr u32 PROBE_LIMIT = 8;
+
+// An existing file is mapped at its own size; a new one is sized for the
+// requested entries.
+u64 initial_size(const std::filesystem::path& path, u64 header_bytes, u64 table_bytes) {
+    std::error_code error;
+    auto size = std::filesystem::file_size(path, error);
+    return !error && size > 0 ? header_bytes : header_bytes + table_bytes;
+}
+
+u32 unix_seconds() {
+    return static_cast<u32>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+AnalysisCache::AnalysisCache(const std::filesystem::path& path, u32 entry_count)
+        : m_file(path, initial_size(path, sizeof(Header),
+                                    static_cast<u64>(std::bit_ceil(std::max(entry_count, PROBE_LIMIT))) *
+                                        sizeof(StoredEntry))) {
+    auto bytes = m_file.writable_bytes();
+    if (bytes.size() < sizeof(Header)) {
+        throw std::runtime_error("Analysis cache '" + path.string() + "' is truncated");
+    }
+    auto* header = reinterpret_cast<Header*>(bytes.data());
+    if (header->magic == std::array<char, 8>{}) {
+        header->magic = CACHE_MAGIC;
+        header->version = CACHE_VERSION;
+        header->entry_count = std::bit_ceil(std::max(entry_count, PROBE_LIMIT));
+    } else if (header->magic != CACHE_MAGIC || header->version != CACHE_VERSION) {
+        throw std::runtime_error("'" + path.string() + "' is not a vgce analysis cache");
+    }
+    if (!std::has_single_bit(header->entry_count) ||
+        (bytes.size() - sizeof(Header)) / sizeof(StoredEntry) < header->entry_count) {
+        throw std::runtime_error("Analysis cache '" + path.string() + "' is truncated");
+    }
+    m_entries = reinterpret_cast<StoredEntry*>(bytes.data() + sizeof(Header));
+    m_mask = header->entry_count - 1;
+}
+
+const AnalysisCache::StoredEntry* AnalysisCache::find(u64 key) const {
+    if (key == 0) {
+        return nullptr;
+    }
+    for (u32 probe = 0; probe < PROBE_LIMIT; ++probe) {
+        const auto& entry = m_entries[(key + probe) & m_mask];
+        if (entry.key == key) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+AnalysisCache::StoredEntry* AnalysisCache::find_or_claim(u64 key) {
+    StoredEntry* victim = nullptr;
+    for (u32 probe = 0; probe < PROBE_LIMIT; ++probe) {
+        auto& entry = m_entries[(key + probe) & m_mask];
+        if (entry.key == key) {
+            return &entry;
+        }
+        if (!victim || (victim->key != 0 && (entry.key == 0 || entry.depth < victim->depth))) {
+            victim = &entry;
+        }
+    }
+    std::memset(victim, 0, sizeof(StoredEntry));
+    victim->key = key;
+    return victim;
+}
+
+std::optional<AnalysisCache::Entry> AnalysisCache::lookup(u64 key) const {
+    const auto* stored = find(key);
+    if (!stored) {
+        return std::nullopt;
+    }
+    Entry entry;
+    entry.depth = stored->depth;
+    for (const auto& stored_line : stored->lines) {
+        if (stored_line.depth == 0) {
+            break;
+        }
+        Line line;
+        line.depth = stored_line.depth;
+        line.score = {stored_line.score_type, stored_line.score};
+        if (stored_line.has_wdl) {
+            line.wdl = uci::WDL{stored_line.wdl[0], stored_line.wdl[1], stored_line.wdl[2]};
+        }
+        for (u8 i = 0; i < std::min<u8>(stored_line.pv_length, MAX_PV_MOVES); ++i) {
+            line.pv.push_back(unpack_uci_move(stored_line.pv[i]));
+        }
+        entry.lines.push_back(std::move(line));
+    }
+    return entry;
+}
+
+u16 AnalysisCache::cached_depth(u64 key) const {
+    const auto* stored = find(key);
+    return stored ? stored->depth : 0;
+}
+
+void AnalysisCache::store(u64 key, const uci::InfoData& data) {
+    u16 multipv = data.multipv.value_or(1);
+    if (key == 0 || multipv == 0 || multipv > MAX_LINES || !data.depth || *data.depth == 0 || !data.score ||
+        data.score->bound != uci::Score::Bound::Exact || data.pv.empty()) {
+        return;
+    }
+    const auto* existing = find(key);
+    if (existing && existing->lines[multipv - 1].depth > *data.depth) {
+        return;
+    }
+
+    StoredLine line{};
+    line.score = data.score->value;
+    line.depth = *data.depth;
+    line.score_type = data.score->type;
+    if (data.wdl) {
+        line.wdl = {static_cast<u16>(data.wdl->win), static_cast<u16>(data.wdl->draw),
+                    static_cast<u16>(data.wdl->loss)};
+        line.has_wdl = 1;
+    }
+    // The cached line ends at the first move that cannot be packed.
+    for (const auto& move : data.pv) {
+        auto packed = pack_uci_move(move);
+        if (!packed || line.pv_length == MAX_PV_MOVES) {
+            break;
+        }
+        line.pv[line.pv_length++] = *packed;
+    }
+
+    auto* entry = find_or_claim(key);
+    entry->lines[multipv - 1] = line;
+    if (multipv == 1) {
+        entry->depth = line.depth;
+    }
+    entry->updated = unix_seconds();
+}
+
+} // namespace vgce::session
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "process/mapped_file.hpp"
+#include "uci/uci_data.hpp"
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace vgce::session {
+
+// A fixed-size hash table of finished analysis in a memory-mapped file,
+// keyed by the root position's Zobrist key. Entries keep the first
+// MAX_LINES MultiPV lines at the deepest exact score seen for each, so
+// reopening a position shows where earlier runs got to. Only the
+// processing thread writes; values are stored in host byte order.
+class AnalysisCache {
+public:
+    static constexpr u32 DEFAULT_ENTRIES = 1 << 16;
+    static constexpr u16 MAX_LINES = 4;
+    static constexpr u16 MAX_PV_MOVES = 24;
+
+    struct Line {
+        u16 depth = 0;
+        uci::Score score{};
+        std::optional<uci::WDL> wdl;
+        std::vector<std::string> pv;
+    };
+
+    struct Entry {
+        // The main line's depth.
+        u16 depth = 0;
+        // In MultiPV order; a missing slot ends the list.
+        std::vector<Line> lines;
+    };
+
+    // Creates the file with entry_count entries, rounded up to a power of
+    // two, or opens an existing one at its own size. Throws
+    // std::runtime_error if the file is not a cache.
+    explicit AnalysisCache(const std::filesystem::path& path, u32 entry_count = DEFAULT_ENTRIES);
+
+    std::optional<Entry> lookup(u64 key) const;
+    u16 cached_depth(u64 key) const;
+    // Keeps an exact-score line for the position if it is at least as deep
+    // as the cached one for its MultiPV slot.
+    void store(u64 key, const uci::InfoData& data);
+    void flush() { m_file.flush(); }
+
+private:
+    struct StoredLine {
+        i32 score;
+        u16 depth;
+        uci::Score::Type score_type;
+        u8 pv_length;
+        std::array<u16, 3> wdl;
+        u8 has_wdl;
+        u8 reserved;
+        std::array<u16, MAX_PV_MOVES> pv;
+    };
+
+    struct StoredEntry {
+        // Zero marks an empty entry.
+        u64 key;
+        u16 depth;
+        u16 reserved;
+        // Unix seconds of the last store.
+        u32 updated;
+        std::array<StoredLine, MAX_LINES> lines;
+    };
+
+    struct Header {
+        std::array<char, 8> magic;
+        u32 version;
+        u32 entry_count;
+    };
+
+    // The file layout; changing it needs a version bump.
+    static_assert(std::is_trivially_copyable_v<StoredEntry>);
+    static_assert(offsetof(StoredLine, wdl) == 8 && offsetof(StoredLine, pv) == 16);
+    static_assert(sizeof(StoredLine) == 16 + MAX_PV_MOVES * 2);
+    static_assert(offsetof(StoredEntry, updated) == 12 && offsetof(StoredEntry, lines) == 16);
+    static_assert(sizeof(StoredEntry) == 16 + MAX_LINES * sizeof(StoredLine));
+    static_assert(sizeof(Header) == 16);
+
+    const StoredEntry* find(u64 key) const;
+    StoredEntry* find_or_claim(u64 key);
+
+    process::MappedFile m_file;
+    StoredEntry* m_entries = nullptr;
+    u32 m_mask = 0;
+};
+
+} // namespace vgce::session
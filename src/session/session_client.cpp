@@ -0,0 +1,87 @@
+#include "session/session_client.hpp"
+#include "byte_buffer.hpp"
+#include <stdexcept>
+
+namespace vgce::session {
+
+namespace {
+
+constexpr auto HELLO_TIMEOUT = std::chrono::seconds(5);
+constexpr u64 RECEIVE_CHUNK_BYTES = 64 * 1024;
+// Beyond any real tree image; a larger size means the stream is corrupt.
+constexpr u32 MAX_RECORD_BYTES = 1u << 30;
+
+} // namespace
+
+SessionClient::SessionClient(const std::filesystem::path& path) : m_socket(process::LocalSocket::connect(path)) {
+    constexpr u64 FIXED_HELLO_BYTES = STREAM_MAGIC.size() + sizeof(u32) + sizeof(u32);
+    auto deadline = std::chrono::steady_clock::now() + HELLO_TIMEOUT;
+    auto wait_for_bytes = [&](u64 count) {
+        while (m_buffer.size() < count) {
+            if (std::chrono::steady_clock::now() >= deadline || !receive(std::chrono::milliseconds(100))) {
+                throw std::runtime_error("No session stream on '" + path.string() + "'");
+            }
+        }
+    };
+
+    wait_for_bytes(FIXED_HELLO_BYTES);
+    ByteReader header(m_buffer);
+    if (header.get<std::array<char, 8>>() != STREAM_MAGIC) {
+        throw std::runtime_error("'" + path.string() + "' is not a vgce server");
+    }
+    if (u32 version = header.get<u32>(); version != FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported session stream version " + std::to_string(version));
+    }
+    u32 name_size = header.get<u32>();
+    wait_for_bytes(FIXED_HELLO_BYTES + name_size);
+    ByteReader hello(m_buffer);
+    hello.take(STREAM_MAGIC.size() + sizeof(u32));
+    m_engine_name = hello.get_string();
+    m_read_pos = FIXED_HELLO_BYTES + name_size;
+}
+
+std::optional<SessionClient::Record> SessionClient::read(std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+        u64 available = m_buffer.size() - m_read_pos;
+        if (available >= RECORD_HEADER_BYTES) {
+            ByteReader reader(std::span<const u8>(m_buffer).subspan(m_read_pos));
+            auto type = reader.get<RecordType>();
+            u32 size = reader.get<u32>();
+            if (size < sizeof(u64) || size > MAX_RECORD_BYTES) {
+                m_is_connected = false;
+                return std::nullopt;
+            }
+            if (available >= RECORD_HEADER_BYTES + size) {
+                Record record{type, reader.get<u64>(), {}};
+                auto body = reader.take(size - sizeof(u64));
+                record.body.assign(body.begin(), body.end());
+                m_read_pos += RECORD_HEADER_BYTES + size;
+                return record;
+            }
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (!m_is_connected || now >= deadline ||
+            !receive(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now))) {
+            return std::nullopt;
+        }
+    }
+}
+
+bool SessionClient::receive(std::chrono::milliseconds timeout) {
+    // Consumed records are dropped once they are half the buffer.
+    if (m_read_pos > 0 && m_read_pos * 2 >= m_buffer.size()) {
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + static_cast<i64>(m_read_pos));
+        m_read_pos = 0;
+    }
+    u64 old_size = m_buffer.size();
+    m_buffer.resize(old_size + RECEIVE_CHUNK_BYTES);
+    i64 received = m_socket.receive(std::span<u8>(m_buffer).subspan(old_size), timeout);
+    m_buffer.resize(old_size + static_cast<u64>(std::max<i64>(received, 0)));
+    if (received < 0) {
+        m_is_connected = false;
+    }
+    return m_is_connected;
+}
+
+} // namespace vgce::session
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "process/local_socket.hpp"
+#include "session/session_format.hpp"
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vgce::session {
+
+// The viewer end of a SessionServer stream.
+class SessionClient {
+public:
+    struct Record {
+        RecordType type;
+        u64 time_ns;
+        // The payload after the time stamp.
+        std::vector<u8> body;
+    };
+
+    // Throws std::runtime_error if no server answers on path or it does not
+    // speak this format.
+    explicit SessionClient(const std::filesystem::path& path);
+
+    // Waits up to timeout for the next record.
+    std::optional<Record> read(std::chrono::milliseconds timeout);
+
+    bool is_connected() const { return m_is_connected; }
+    const std::string& engine_name() const { return m_engine_name; }
+
+private:
+    // Returns false once the server is gone.
+    bool receive(std::chrono::milliseconds timeout);
+
+    process::LocalSocket m_socket;
+    std::vector<u8> m_buffer;
+    u64 m_read_pos = 0;
+    bool m_is_connected = true;
+    std::string m_engine_name;
+};
+
+} // namespace vgce::session
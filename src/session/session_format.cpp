@@ -0,0 +1,186 @@
+#include "session/session_format.hpp"
+#include "byte_buffer.hpp"
+
+namespace vgce::session {
+
+namespace {
+
+enum InfoField : u16 {
+    DEPTH = 1 << 0,
+    SELDEPTH = 1 << 1,
+    SCORE = 1 << 2,
+    NODES = 1 << 3,
+    NPS = 1 << 4,
+    TBHITS = 1 << 5,
+    HASHFULL = 1 << 6,
+    TIME = 1 << 7,
+    MULTIPV = 1 << 8,
+    WDL = 1 << 9,
+};
+
+constexpr std::string_view PROMOTION_CHARS = " nbrq";
+constexpr u16 NO_MOVE = 0xFFFF;
+
+std::optional<u8> parse_square(char file, char rank) {
+    if (file < 'a' || file > 'h' || rank < '1' || rank > '8') {
+        return std::nullopt;
+    }
+    return static_cast<u8>((rank - '1') * 8 + (file - 'a'));
+}
+
+template <typename T>
+void put_optional(ByteWriter& writer, const std::optional<T>& value) {
+    if (value) {
+        writer.put(*value);
+    }
+}
+
+template <typename T>
+void get_optional(ByteReader& reader, u16 fields, u16 field, std::optional<T>& value) {
+    if (fields & field) {
+        value = reader.get<T>();
+    }
+}
+
+} // namespace
+
+void IndexBuilder::on_checkpoint(u64 offset, u64 time_ns, bool root_change) {
+    if (root_change) {
+        m_segment_depth = 0;
+    }
+    m_entries.push_back({root_change ? IndexEntry::Kind::RootChange : IndexEntry::Kind::Checkpoint,
+                         m_segment_depth, offset, time_ns});
+}
+
+void IndexBuilder::on_info(u64 offset, u64 time_ns, const uci::InfoData& data) {
+    if (data.multipv.value_or(1) != 1 || !data.depth || *data.depth <= m_segment_depth) {
+        return;
+    }
+    m_segment_depth = *data.depth;
+    m_entries.push_back({IndexEntry::Kind::Depth, m_segment_depth, offset, time_ns});
+}
+
+std::optional<u16> pack_uci_move(std::string_view uci) {
+    if (uci.size() != 4 && uci.size() != 5) {
+        return std::nullopt;
+    }
+    auto from = parse_square(uci[0], uci[1]);
+    auto to = parse_square(uci[2], uci[3]);
+    if (!from || !to) {
+        return std::nullopt;
+    }
+    u16 promotion = 0;
+    if (uci.size() == 5) {
+        auto pos = PROMOTION_CHARS.find(uci[4]);
+        if (pos == std::string_view::npos || pos == 0) {
+            return std::nullopt;
+        }
+        promotion = static_cast<u16>(pos);
+    }
+    return static_cast<u16>(*from | (*to << 6) | (promotion << 12));
+}
+
+std::string unpack_uci_move(u16 packed) {
+    auto square = [](u16 index) {
+        return std::string{static_cast<char>('a' + index % 8), static_cast<char>('1' + index / 8)};
+    };
+    std::string uci = square(packed & 63) + square((packed >> 6) & 63);
+    u16 promotion = (packed >> 12) & 7;
+    if (promotion > 0 && promotion < PROMOTION_CHARS.size()) {
+        uci += PROMOTION_CHARS[promotion];
+    }
+    return uci;
+}
+
+void encode_info(const uci::InfoData& data, std::vector<u8>& out) {
+    ByteWriter writer(out);
+    u16 fields = (data.depth ? DEPTH : 0) | (data.seldepth ? SELDEPTH : 0) | (data.score ? SCORE : 0) |
+                 (data.nodes ? NODES : 0) | (data.nps ? NPS : 0) | (data.tbhits ? TBHITS : 0) |
+                 (data.hashfull ? HASHFULL : 0) | (data.time ? TIME : 0) | (data.multipv ? MULTIPV : 0) |
+                 (data.wdl ? WDL : 0);
+    writer.put(fields);
+    put_optional(writer, data.depth);
+    put_optional(writer, data.seldepth);
+    if (data.score) {
+        writer.put(data.score->type);
+        writer.put(data.score->bound);
+        writer.put(data.score->value);
+    }
+    put_optional(writer, data.nodes);
+    put_optional(writer, data.nps);
+    put_optional(writer, data.tbhits);
+    put_optional(writer, data.hashfull);
+    put_optional(writer, data.time);
+    put_optional(writer, data.multipv);
+    put_optional(writer, data.wdl);
+
+    // A malformed move is kept as a marker so the tree cuts the line there,
+    // as it would have live.
+    writer.put(static_cast<u16>(data.pv.size()));
+    for (const auto& move : data.pv) {
+        writer.put(pack_uci_move(move).value_or(NO_MOVE));
+    }
+}
+
+uci::InfoData decode_info(std::span<const u8> body) {
+    ByteReader reader(body);
+    uci::InfoData data;
+    u16 fields = reader.get<u16>();
+    get_optional(reader, fields, DEPTH, data.depth);
+    get_optional(reader, fields, SELDEPTH, data.seldepth);
+    if (fields & SCORE) {
+        uci::Score score;
+        score.type = reader.get<uci::Score::Type>();
+        score.bound = reader.get<uci::Score::Bound>();
+        score.value = reader.get<i32>();
+        data.score = score;
+    }
+    get_optional(reader, fields, NODES, data.nodes);
+    get_optional(reader, fields, NPS, data.nps);
+    get_optional(reader, fields, TBHITS, data.tbhits);
+    get_optional(reader, fields, HASHFULL, data.hashfull);
+    get_optional(reader, fields, TIME, data.time);
+    get_optional(reader, fields, MULTIPV, data.multipv);
+    get_optional(reader, fields, WDL, data.wdl);
+
+    u16 pv_size = reader.get<u16>();
+    data.pv.reserve(pv_size);
+    for (u16 i = 0; i < pv_size; ++i) {
+        u16 packed = reader.get<u16>();
+        data.pv.push_back(packed == NO_MOVE ? "-" : unpack_uci_move(packed));
+    }
+    return data;
+}
+
+void encode_index(const std::vector<IndexEntry>& entries, std::vector<u8>& out) {
+    ByteWriter writer(out);
+    writer.put(static_cast<u64>(entries.size()));
+    for (const auto& entry : entries) {
+        writer.put(entry.kind);
+        writer.put(entry.depth);
+        writer.put(entry.offset);
+        writer.put(entry.time_ns);
+    }
+}
+
+std::vector<IndexEntry> decode_index(std::span<const u8> body) {
+    constexpr u64 ENTRY_BYTES = sizeof(u8) + sizeof(u16) + 2 * sizeof(u64);
+    ByteReader reader(body);
+    u64 count = reader.get<u64>();
+    if (count > reader.remaining() / ENTRY_BYTES) {
+        throw std::runtime_error("Session index is truncated");
+    }
+    std::vector<IndexEntry> entries;
+    entries.reserve(count);
+    for (u64 i = 0; i < count; ++i) {
+        IndexEntry entry;
+        entry.kind = reader.get<IndexEntry::Kind>();
+        entry.depth = reader.get<u16>();
+        entry.offset = reader.get<u64>();
+        entry.time_ns = reader.get<u64>();
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+} // namespace vgce::session
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "uci/uci_data.hpp"
+#include <array>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vgce::session {
+
+// A session file is a header followed by records. Each record is a type
+// byte, a u32 payload size and the payload, which starts with the record's
+// u64 time in nanoseconds since recording began. A finished file ends with
+// an Index record and a trailer pointing at it.
+constexpr std::array<char, 8> FILE_MAGIC = {'V', 'G', 'C', 'E', 'S', 'E', 'S', '1'};
+constexpr std::array<char, 8> TRAILER_MAGIC = {'V', 'G', 'C', 'E', 'I', 'D', 'X', '1'};
+constexpr u32 FORMAT_VERSION = 1;
+constexpr u64 RECORD_HEADER_BYTES = sizeof(u8) + sizeof(u32);
+// Index record offset followed by TRAILER_MAGIC.
+constexpr u64 TRAILER_BYTES = sizeof(u64) + TRAILER_MAGIC.size();
+
+// A live stream from SessionServer is STREAM_MAGIC, FORMAT_VERSION and the
+// engine name, then records framed as in a file: root-change checkpoints
+// (sent whenever a viewer must start over) and info lines, with no index.
+constexpr std::array<char, 8> STREAM_MAGIC = {'V', 'G', 'C', 'E', 'L', 'I', 'V', '1'};
+
+enum class RecordType : u8 {
+    Info = 1,
+    // A u8 root-change flag followed by a SearchTree::save() image.
+    Checkpoint = 2,
+    Index = 3,
+};
+
+struct IndexEntry {
+    enum class Kind : u8 {
+        // A periodic tree image that bounds how far a seek replays.
+        Checkpoint,
+        // A new root position or a cleared tree; starts a segment.
+        RootChange,
+        // The first main-line info line at a new depth within a segment.
+        Depth,
+    };
+
+    Kind kind = Kind::Checkpoint;
+    u16 depth = 0;
+    u64 offset = 0;
+    u64 time_ns = 0;
+
+    bool is_checkpoint() const { return kind != Kind::Depth; }
+};
+
+// Builds the index the same way while recording and when scanning a file
+// that was never finished.
+class IndexBuilder {
+public:
+    void on_checkpoint(u64 offset, u64 time_ns, bool root_change);
+    void on_info(u64 offset, u64 time_ns, const uci::InfoData& data);
+
+    const std::vector<IndexEntry>& entries() const { return m_entries; }
+    std::vector<IndexEntry> take() { return std::move(m_entries); }
+
+private:
+    std::vector<IndexEntry> m_entries;
+    u16 m_segment_depth = 0;
+};
+
+// UCI moves are packed into 16 bits: from and to squares and a promotion
+// piece, so recording needs no position.
+std::optional<u16> pack_uci_move(std::string_view uci);
+std::string unpack_uci_move(u16 packed);
+
+void encode_info(const uci::InfoData& data, std::vector<u8>& out);
+// The payload after the time stamp.
+uci::InfoData decode_info(std::span<const u8> body);
+
+void encode_index(const std::vector<IndexEntry>& entries, std::vector<u8>& out);
+std::vector<IndexEntry> decode_index(std::span<const u8> body);
+
+} // namespace vgce::session
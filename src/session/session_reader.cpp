@@ -0,0 +1,152 @@
+#include "session/session_reader.hpp"
+#include "byte_buffer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace vgce::session {
+
+SessionReader::SessionReader(const std::filesystem::path& path) : m_file(path), m_data(m_file.bytes()) {
+    try {
+        ByteReader header(m_data);
+        if (header.get<std::array<char, 8>>() != FILE_MAGIC) {
+            throw std::runtime_error("bad magic");
+        }
+        if (header.get<u32>() != FORMAT_VERSION) {
+            throw std::runtime_error("unsupported version");
+        }
+        header.get<u64>();
+        m_engine_name = header.get_string();
+        m_first_offset = m_data.size() - header.remaining();
+    } catch (const std::exception& e) {
+        throw std::runtime_error("'" + path.string() + "' is not a vgce session: " + e.what());
+    }
+
+    m_end_offset = m_data.size();
+    if (m_data.size() >= m_first_offset + TRAILER_BYTES) {
+        ByteReader trailer(m_data.subspan(m_data.size() - TRAILER_BYTES));
+        u64 index_offset = trailer.get<u64>();
+        if (trailer.get<std::array<char, 8>>() == TRAILER_MAGIC && index_offset >= m_first_offset &&
+            index_offset < m_data.size() - TRAILER_BYTES) {
+            m_end_offset = m_data.size() - TRAILER_BYTES;
+            auto record = read(index_offset);
+            if (record && record->type == RecordType::Index) {
+                try {
+                    m_index = decode_index(record->body);
+                    m_duration_ns = record->time_ns;
+                    m_end_offset = index_offset;
+                    return;
+                } catch (const std::exception&) {
+                    // A damaged index is rebuilt from the records below.
+                }
+            }
+            m_end_offset = m_data.size();
+        }
+    }
+    scan();
+}
+
+std::optional<SessionReader::Record> SessionReader::read(u64 offset) const {
+    if (offset < m_first_offset || offset + RECORD_HEADER_BYTES > m_end_offset) {
+        return std::nullopt;
+    }
+    u32 size;
+    std::memcpy(&size, m_data.data() + offset + 1, sizeof(size));
+    u64 next = offset + RECORD_HEADER_BYTES + size;
+    if (next > m_end_offset || size < sizeof(u64)) {
+        return std::nullopt;
+    }
+    Record record{static_cast<RecordType>(m_data[offset]), offset, next, 0,
+                  m_data.subspan(offset + RECORD_HEADER_BYTES + sizeof(u64), size - sizeof(u64))};
+    std::memcpy(&record.time_ns, m_data.data() + offset + RECORD_HEADER_BYTES, sizeof(u64));
+    return record;
+}
+
+// Stops at the first incomplete or unreadable record, which is where a
+// crashed recording ended.
+void SessionReader::scan() {
+    IndexBuilder builder;
+    u64 offset = m_first_offset;
+    while (auto record = read(offset)) {
+        try {
+            if (record->type == RecordType::Info) {
+                builder.on_info(offset, record->time_ns, decode_info(record->body));
+            } else if (record->type == RecordType::Checkpoint && !record->body.empty()) {
+                builder.on_checkpoint(offset, record->time_ns, record->body[0] != 0);
+            } else {
+                break;
+            }
+        } catch (const std::exception&) {
+            break;
+        }
+        m_duration_ns = record->time_ns;
+        offset = record->next;
+    }
+    m_end_offset = offset;
+    m_index = builder.take();
+}
+
+const IndexEntry* SessionReader::checkpoint_at_offset(u64 offset) const {
+    auto it = std::upper_bound(m_index.begin(), m_index.end(), offset,
+                               [](u64 value, const IndexEntry& entry) { return value < entry.offset; });
+    while (it != m_index.begin()) {
+        --it;
+        if (it->is_checkpoint()) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+const IndexEntry* SessionReader::checkpoint_at_time(u64 time_ns) const {
+    auto it = std::upper_bound(m_index.begin(), m_index.end(), time_ns,
+                               [](u64 value, const IndexEntry& entry) { return value < entry.time_ns; });
+    while (it != m_index.begin()) {
+        --it;
+        if (it->is_checkpoint()) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+const IndexEntry* SessionReader::segment_start(u64 offset) const {
+    const IndexEntry* start = nullptr;
+    for (const auto& entry : m_index) {
+        if (entry.offset > offset) {
+            break;
+        }
+        if (entry.kind == IndexEntry::Kind::RootChange) {
+            start = &entry;
+        }
+    }
+    return start;
+}
+
+const IndexEntry* SessionReader::depth_reached(u64 offset, u16 depth) const {
+    const IndexEntry* start = segment_start(offset);
+    auto it = start ? m_index.begin() + (start - m_index.data()) + 1 : m_index.begin();
+    for (; it != m_index.end() && it->kind != IndexEntry::Kind::RootChange; ++it) {
+        if (it->kind == IndexEntry::Kind::Depth && it->depth >= depth) {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+u16 SessionReader::depth_at(u64 offset) const {
+    for (auto it = m_index.rbegin(); it != m_index.rend(); ++it) {
+        if (it->offset > offset) {
+            continue;
+        }
+        if (it->kind == IndexEntry::Kind::RootChange) {
+            return 0;
+        }
+        if (it->kind == IndexEntry::Kind::Depth) {
+            return it->depth;
+        }
+    }
+    return 0;
+}
+
+} // namespace vgce::session
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "process/mapped_file.hpp"
+#include "session/session_format.hpp"
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace vgce::session {
+
+// A memory-mapped session file. Finished files are opened through their
+// index; an unfinished one, e.g. after a crash, is scanned once to rebuild
+// it and read up to its last complete record.
+class SessionReader {
+public:
+    struct Record {
+        RecordType type;
+        u64 offset;
+        u64 next;
+        u64 time_ns;
+        // The payload after the time stamp.
+        std::span<const u8> body;
+    };
+
+    // Throws std::runtime_error if the file is not a session file.
+    explicit SessionReader(const std::filesystem::path& path);
+
+    // Returns nothing at the end of the records.
+    std::optional<Record> read(u64 offset) const;
+
+    u64 first_offset() const { return m_first_offset; }
+    u64 duration_ns() const { return m_duration_ns; }
+    const std::string& engine_name() const { return m_engine_name; }
+    const std::vector<IndexEntry>& index() const { return m_index; }
+
+    // The last checkpoint at or before the offset or time.
+    const IndexEntry* checkpoint_at_offset(u64 offset) const;
+    const IndexEntry* checkpoint_at_time(u64 time_ns) const;
+    // The first info line reaching the depth, in the segment containing offset.
+    const IndexEntry* depth_reached(u64 offset, u16 depth) const;
+    // The main-line depth reached by the line at offset, 0 if none.
+    u16 depth_at(u64 offset) const;
+
+private:
+    void scan();
+    const IndexEntry* segment_start(u64 offset) const;
+
+    process::MappedFile m_file;
+    std::span<const u8> m_data;
+    u64 m_first_offset = 0;
+    u64 m_end_offset = 0;
+    u64 m_duration_ns = 0;
+    std::string m_engine_name;
+    std::vector<IndexEntry> m_index;
+};
+
+} // namespace vgce::session
@@ -0,0 +1,98 @@
+#include "session/session_recorder.hpp"
+#include "byte_buffer.hpp"
+#include "metrics/clock.hpp"
+#include "metrics/trace.hpp"
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace vgce::session {
+
+namespace {
+
+// A checkpoint is written after whichever comes first, bounding both the
+// number of lines a seek replays and the time it covers.
+constexpr u64 CHECKPOINT_INFOS = 4096;
+constexpr u64 CHECKPOINT_INTERVAL_NS = 10'000'000'000;
+
+} // namespace
+
+SessionRecorder::SessionRecorder(const std::filesystem::path& path, const std::string& engine_name)
+        : m_file(path, std::ios::out | std::ios::binary | std::ios::trunc),
+          m_start_ns(metrics::monotonic_ns()) {
+    if (!m_file.is_open()) {
+        throw std::runtime_error("Cannot create session file '" + path.string() + "'");
+    }
+    m_last_checkpoint_ns = m_start_ns;
+
+    std::vector<u8> header;
+    ByteWriter writer(header);
+    writer.put(FILE_MAGIC);
+    writer.put(FORMAT_VERSION);
+    writer.put(static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()));
+    writer.put_string(engine_name);
+    m_file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    m_offset = header.size();
+}
+
+SessionRecorder::~SessionRecorder() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    u64 index_offset = m_offset;
+    m_payload.clear();
+    ByteWriter writer(m_payload);
+    writer.put(metrics::monotonic_ns() - m_start_ns);
+    encode_index(m_index.entries(), m_payload);
+    write_record(RecordType::Index);
+
+    std::vector<u8> trailer;
+    ByteWriter trailer_writer(trailer);
+    trailer_writer.put(index_offset);
+    trailer_writer.put(TRAILER_MAGIC);
+    m_file.write(reinterpret_cast<const char*>(trailer.data()), static_cast<std::streamsize>(trailer.size()));
+}
+
+void SessionRecorder::record_info(const uci::InfoData& data) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    u64 time_ns = metrics::monotonic_ns() - m_start_ns;
+    m_payload.clear();
+    ByteWriter writer(m_payload);
+    writer.put(time_ns);
+    encode_info(data, m_payload);
+    m_index.on_info(m_offset, time_ns, data);
+    write_record(RecordType::Info);
+    m_infos_since_checkpoint++;
+}
+
+void SessionRecorder::record_checkpoint(const model::SearchTree& tree, bool root_change) {
+    VGCE_TRACE_SCOPE("session.checkpoint");
+    std::lock_guard<std::mutex> lock(m_mutex);
+    u64 now_ns = metrics::monotonic_ns();
+    m_payload.clear();
+    ByteWriter writer(m_payload);
+    writer.put(now_ns - m_start_ns);
+    writer.put(static_cast<u8>(root_change));
+    tree.save(m_payload);
+    m_index.on_checkpoint(m_offset, now_ns - m_start_ns, root_change);
+    write_record(RecordType::Checkpoint);
+    m_last_checkpoint_ns = now_ns;
+    m_infos_since_checkpoint = 0;
+}
+
+bool SessionRecorder::checkpoint_due() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_infos_since_checkpoint >= CHECKPOINT_INFOS ||
+           (m_infos_since_checkpoint > 0 && metrics::monotonic_ns() - m_last_checkpoint_ns >= CHECKPOINT_INTERVAL_NS);
+}
+
+void SessionRecorder::write_record(RecordType type) {
+    std::array<u8, RECORD_HEADER_BYTES> header;
+    auto size = static_cast<u32>(m_payload.size());
+    header[0] = static_cast<u8>(type);
+    std::memcpy(header.data() + 1, &size, sizeof(size));
+    m_file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    m_file.write(reinterpret_cast<const char*>(m_payload.data()), static_cast<std::streamsize>(m_payload.size()));
+    m_offset += header.size() + m_payload.size();
+}
+
+} // namespace vgce::session
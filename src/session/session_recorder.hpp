@@ -0,0 +1,41 @@
+#pragma once
+
+#include "model/search_tree.hpp"
+#include "session/session_format.hpp"
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace vgce::session {
+
+// Appends info lines and tree checkpoints to a session file. The index is
+// written when the recorder is destroyed; safe to call from any thread.
+class SessionRecorder {
+public:
+    // Throws std::runtime_error if the file cannot be created.
+    SessionRecorder(const std::filesystem::path& path, const std::string& engine_name);
+    ~SessionRecorder();
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    void record_info(const uci::InfoData& data);
+    // Root changes start a new segment; other checkpoints only shorten seeks.
+    void record_checkpoint(const model::SearchTree& tree, bool root_change);
+    bool checkpoint_due() const;
+
+private:
+    void write_record(RecordType type);
+
+    std::ofstream m_file;
+    mutable std::mutex m_mutex;
+    u64 m_offset = 0;
+    u64 m_start_ns = 0;
+    u64 m_last_checkpoint_ns = 0;
+    u64 m_infos_since_checkpoint = 0;
+    IndexBuilder m_index;
+    // Reused for each record's payload.
+    std::vector<u8> m_payload;
+};
+
+} // namespace vgce::session
@@ -0,0 +1,245 @@
+#include "session/session_server.hpp"
+#include "byte_buffer.hpp"
+#include "metrics/clock.hpp"
+#include "metrics/trace.hpp"
+#include <algorithm>
+
+namespace vgce::session {
+
+namespace {
+
+// A viewer with a backlog is retried this often; an idle server still wakes
+// to accept new viewers.
+constexpr auto BACKLOG_RETRY = std::chrono::milliseconds(2);
+constexpr auto IDLE_WAIT = std::chrono::milliseconds(50);
+// Queued records are coalesced into sends of up to this size.
+constexpr u64 SEND_CHUNK_BYTES = 64 * 1024;
+
+bool is_checkpoint(const std::vector<u8>& record) {
+    return record[0] == static_cast<u8>(RecordType::Checkpoint);
+}
+
+} // namespace
+
+SessionServer::SessionServer(const std::filesystem::path& path, std::string engine_name,
+                             const model::SearchTree& tree)
+        : m_listener(process::LocalSocket::listen(path)), m_engine_name(std::move(engine_name)), m_tree(tree),
+          m_start_ns(metrics::monotonic_ns()) {
+    m_thread = std::thread(&SessionServer::run, this);
+}
+
+SessionServer::~SessionServer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_is_running.store(false);
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void SessionServer::publish_info(const uci::InfoData& data) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_viewers.empty()) {
+            return;
+        }
+    }
+    std::vector<u8> body;
+    encode_info(data, body);
+    auto record = make_record(RecordType::Info, body);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    enqueue(record);
+}
+
+void SessionServer::publish_root_change() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_viewers.empty()) {
+            return;
+        }
+    }
+    auto checkpoint = make_checkpoint();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    enqueue(checkpoint);
+}
+
+u64 SessionServer::viewer_count() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_viewers.size();
+}
+
+SessionServer::Record SessionServer::make_checkpoint() const {
+    VGCE_TRACE_SCOPE("server.checkpoint");
+    std::vector<u8> body;
+    body.push_back(1);
+    m_tree.save(body);
+    return make_record(RecordType::Checkpoint, body);
+}
+
+SessionServer::Record SessionServer::make_record(RecordType type, const std::vector<u8>& body) const {
+    auto record = std::make_shared<std::vector<u8>>();
+    record->reserve(RECORD_HEADER_BYTES + sizeof(u64) + body.size());
+    ByteWriter writer(*record);
+    writer.put(static_cast<u8>(type));
+    writer.put(static_cast<u32>(sizeof(u64) + body.size()));
+    writer.put(metrics::monotonic_ns() - m_start_ns);
+    record->insert(record->end(), body.begin(), body.end());
+    return record;
+}
+
+void SessionServer::enqueue(const Record& record) {
+    bool checkpoint = is_checkpoint(*record);
+    for (auto& viewer : m_viewers) {
+        if (checkpoint) {
+            insert_checkpoint(*viewer, record);
+            continue;
+        }
+        if (viewer->info_bytes > MAX_BACKLOG_BYTES) {
+            // Records already in flight are finished, so the stream remains
+            // framed; the checkpoint that follows covers the rest.
+            viewer->backlog.clear();
+            viewer->info_bytes = 0;
+            viewer->needs_checkpoint = true;
+            m_resyncs.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        viewer->backlog.push_back(record);
+        viewer->info_bytes += record->size();
+    }
+    m_has_news = true;
+    m_wake.notify_one();
+}
+
+// Lines published while the image was taken are queued behind it; replaying
+// one the image already holds leaves the tree as it was.
+void SessionServer::insert_checkpoint(Viewer& viewer, const Record& checkpoint) {
+    viewer.backlog.push_front(checkpoint);
+    viewer.needs_checkpoint = false;
+}
+
+void SessionServer::take(Viewer& viewer) {
+    u64 pending = 0;
+    for (const auto& record : viewer.in_flight) {
+        pending += record->size();
+    }
+    pending -= viewer.sent;
+    while (pending < SEND_CHUNK_BYTES && !viewer.backlog.empty()) {
+        auto record = std::move(viewer.backlog.front());
+        viewer.backlog.pop_front();
+        viewer.info_bytes -= is_checkpoint(*record) ? 0 : record->size();
+        pending += record->size();
+        viewer.in_flight.push_back(std::move(record));
+    }
+}
+
+bool SessionServer::flush(Viewer& viewer) {
+    while (!viewer.in_flight.empty()) {
+        m_send_buffer.clear();
+        u64 offset = viewer.sent;
+        for (const auto& record : viewer.in_flight) {
+            u64 take = std::min<u64>(record->size() - offset, SEND_CHUNK_BYTES - m_send_buffer.size());
+            m_send_buffer.insert(m_send_buffer.end(), record->begin() + static_cast<i64>(offset),
+                                 record->begin() + static_cast<i64>(offset + take));
+            offset = 0;
+            if (m_send_buffer.size() >= SEND_CHUNK_BYTES) {
+                break;
+            }
+        }
+
+        i64 sent = viewer.socket.send_some(m_send_buffer);
+        if (sent < 0) {
+            return false;
+        }
+        u64 remaining = static_cast<u64>(sent);
+        while (remaining > 0) {
+            const auto& front = *viewer.in_flight.front();
+            u64 step = std::min(front.size() - viewer.sent, remaining);
+            viewer.sent += step;
+            remaining -= step;
+            if (viewer.sent == front.size()) {
+                viewer.in_flight.pop_front();
+                viewer.sent = 0;
+            }
+        }
+        if (static_cast<u64>(sent) < m_send_buffer.size()) {
+            break;
+        }
+    }
+    return true;
+}
+
+void SessionServer::run() {
+    VGCE_TRACE_THREAD("server");
+    std::vector<u8> hello;
+    ByteWriter writer(hello);
+    writer.put(STREAM_MAGIC);
+    writer.put(FORMAT_VERSION);
+    writer.put_string(m_engine_name);
+
+    while (m_is_running.load()) {
+        // The hello fits any fresh socket buffer; a viewer that cannot take
+        // it is dropped.
+        while (auto peer = m_listener.accept()) {
+            if (peer->send_some(hello) == static_cast<i64>(hello.size())) {
+                auto viewer = std::make_unique<Viewer>();
+                viewer->socket = std::move(*peer);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_viewers.push_back(std::move(viewer));
+            }
+        }
+
+        bool wants_checkpoint = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& viewer : m_viewers) {
+                wants_checkpoint |= viewer->needs_checkpoint;
+            }
+        }
+        if (wants_checkpoint) {
+            auto checkpoint = make_checkpoint();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& viewer : m_viewers) {
+                if (viewer->needs_checkpoint) {
+                    insert_checkpoint(*viewer, checkpoint);
+                }
+            }
+        }
+
+        // Only taking records holds the lock; publish_info never waits on a
+        // socket.
+        std::vector<const Viewer*> gone;
+        for (auto& viewer : m_viewers) {
+            while (true) {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    take(*viewer);
+                }
+                if (viewer->in_flight.empty()) {
+                    break;
+                }
+                if (!flush(*viewer)) {
+                    gone.push_back(viewer.get());
+                    break;
+                }
+                if (!viewer->in_flight.empty()) {
+                    break;
+                }
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        std::erase_if(m_viewers, [&gone](const std::unique_ptr<Viewer>& viewer) {
+            return std::find(gone.begin(), gone.end(), viewer.get()) != gone.end();
+        });
+        bool is_backlogged = std::any_of(m_viewers.begin(), m_viewers.end(), [](const auto& viewer) {
+            return !viewer->backlog.empty() || !viewer->in_flight.empty();
+        });
+        m_wake.wait_for(lock, is_backlogged ? BACKLOG_RETRY : IDLE_WAIT,
+                        [this] { return m_has_news || !m_is_running.load(); });
+        m_has_news = false;
+    }
+}
+
+} // namespace vgce::session
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "model/search_tree.hpp"
+#include "process/local_socket.hpp"
+#include "session/session_format.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vgce::session {
+
+// Streams the session live over a local socket to any number of viewers
+// (vgce --connect). Each viewer starts from a checkpoint of the tree and
+// then gets every info line. A record is encoded once and shared by every
+// viewer's backlog; a viewer more than MAX_BACKLOG_BYTES behind loses its
+// backlog and gets a fresh checkpoint once it has drained, so a slow viewer
+// never holds back the engine or the others. Safe to call from any thread.
+class SessionServer {
+public:
+    static constexpr u64 MAX_BACKLOG_BYTES = 4 << 20;
+
+    // Throws std::runtime_error if the socket cannot be listened on.
+    SessionServer(const std::filesystem::path& path, std::string engine_name, const model::SearchTree& tree);
+    ~SessionServer();
+
+    SessionServer(const SessionServer&) = delete;
+    SessionServer& operator=(const SessionServer&) = delete;
+
+    void publish_info(const uci::InfoData& data);
+    // Called with the tree already at its new root or cleared.
+    void publish_root_change();
+
+    u64 viewer_count() const;
+    // Backlogs dropped for viewers that fell behind.
+    u64 resync_count() const { return m_resyncs.load(std::memory_order_relaxed); }
+
+private:
+    using Record = std::shared_ptr<const std::vector<u8>>;
+
+    struct Viewer {
+        // Guarded by m_mutex.
+        std::deque<Record> backlog;
+        // Bytes of queued info lines. Checkpoints are left out of the backlog
+        // limit, so a tree image larger than the limit cannot make a viewer
+        // resync forever.
+        u64 info_bytes = 0;
+        bool needs_checkpoint = true;
+
+        // Server thread only, so sending never holds m_mutex: records taken
+        // off the backlog, and the bytes of the front one already sent.
+        process::LocalSocket socket;
+        std::deque<Record> in_flight;
+        u64 sent = 0;
+    };
+
+    void run();
+    Record make_checkpoint() const;
+    Record make_record(RecordType type, const std::vector<u8>& body) const;
+    // These three are called with m_mutex held.
+    void enqueue(const Record& record);
+    void insert_checkpoint(Viewer& viewer, const Record& checkpoint);
+    // Moves records from the backlog to in_flight, up to a send's worth.
+    void take(Viewer& viewer);
+    // Sends in_flight records until the socket stops taking them; false once
+    // the viewer is gone. Called without m_mutex.
+    bool flush(Viewer& viewer);
+
+    process::LocalSocket m_listener;
+    std::string m_engine_name;
+    const model::SearchTree& m_tree;
+    u64 m_start_ns = 0;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_has_news = false;
+    // Changed by the server thread only, which may read it unlocked.
+    std::vector<std::unique_ptr<Viewer>> m_viewers;
+    std::atomic<u64> m_resyncs{0};
+    std::atomic<bool> m_is_running{true};
+    // Server thread only.
+    std::vector<u8> m_send_buffer;
+    std::thread m_thread;
+};
+
+} // namespace vgce::session
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "types.hpp"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+
+namespace vgce::session {
+
+// The live search snapshot that vgce --shm <name> publishes in shared memory
+// for other processes to poll. The layout is fixed and little-endian, so a
+// reader in any language can map it:
+//
+//   offset  size  field
+//        0     8  magic "VGCESNP1"
+//        8     4  u32 version (SNAPSHOT_VERSION)
+//       12     4  u32 size of the whole region in bytes
+//       16     8  u64 sequence, odd while an update is being written
+//       24     8  u64 publisher process id
+//       32     8  u64 update time, Unix milliseconds
+//       40     8  u64 nodes
+//       48     8  u64 engine time in ms
+//       56     4  u32 nps
+//       60     4  u32 tbhits
+//       64     2  u16 hashfull, per mille
+//       66     2  u16 main-line depth
+//       68     2  u16 number of valid lines
+//       70     2  reserved
+//       72    64  engine name, NUL-terminated
+//      136   104  root FEN, NUL-terminated
+//      240  8x256 lines, best first:
+//                   0  u16 multipv     2  u16 depth     4  i32 score
+//                   8  u8 score type (0 centipawns, 1 mate)
+//                   9  u8 bound (0 exact, 1 lower, 2 upper)
+//                  10  u16 has_wdl    12  u16 wdl[3], per mille
+//                  18  reserved       20  PV, space-separated UCI moves
+//
+// Scores are from the root side to move's point of view. Updates follow the
+// seqlock protocol: a reader copies the region and keeps the copy only if
+// the sequence was even and unchanged across the copy.
+constexpr std::array<char, 8> SNAPSHOT_MAGIC = {'V', 'G', 'C', 'E', 'S', 'N', 'P', '1'};
+constexpr u32 SNAPSHOT_VERSION = 1;
+constexpr u64 SNAPSHOT_LINES = 8;
+
+struct SnapshotLine {
+    u16 multipv;
+    u16 depth;
+    i32 score;
+    u8 score_type;
+    u8 bound;
+    u16 has_wdl;
+    std::array<u16, 3> wdl;
+    u16 reserved;
+    std::array<char, 236> pv;
+};
+
+struct SharedSnapshot {
+    std::array<char, 8> magic;
+    u32 version;
+    u32 size;
+    u64 sequence;
+    u64 pid;
+    u64 unix_ms;
+    u64 nodes;
+    u64 time_ms;
+    u32 nps;
+    u32 tbhits;
+    u16 hashfull;
+    u16 depth;
+    u16 line_count;
+    u16 reserved;
+    std::array<char, 64> engine_name;
+    std::array<char, 104> root_fen;
+    std::array<SnapshotLine, SNAPSHOT_LINES> lines;
+};
+
+static_assert(std::is_trivially_copyable_v<SharedSnapshot>);
+static_assert(sizeof(SnapshotLine) == 256 && offsetof(SnapshotLine, pv) == 20);
+static_assert(offsetof(SharedSnapshot, sequence) == 16 && offsetof(SharedSnapshot, pid) == 24);
+static_assert(offsetof(SharedSnapshot, engine_name) == 72 && offsetof(SharedSnapshot, lines) == 240);
+static_assert(sizeof(SharedSnapshot) == 240 + SNAPSHOT_LINES * 256);
+static_assert(std::atomic_ref<u64>::is_always_lock_free);
+// The struct is copied in host order, which the layout above fixes as
+// little-endian.
+static_assert(std::endian::native == std::endian::little);
+
+// Publishes the fields after the sequence. Single writer only.
+inline void write_snapshot(std::span<u8> region, const SharedSnapshot& snapshot) {
+    if (region.size() < sizeof(SharedSnapshot)) {
+        return;
+    }
+    auto* shared = reinterpret_cast<SharedSnapshot*>(region.data());
+    std::atomic_ref<u64> sequence(shared->sequence);
+    u64 before = sequence.load(std::memory_order_relaxed);
+    sequence.store(before + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    constexpr u64 HEAD = offsetof(SharedSnapshot, pid);
+    std::memcpy(region.data() + HEAD, reinterpret_cast<const u8*>(&snapshot) + HEAD,
+                sizeof(SharedSnapshot) - HEAD);
+    sequence.store(before + 2, std::memory_order_release);
+}
+
+// Returns a consistent copy, or nothing if the region is not a snapshot or
+// stays mid-update (a publisher that died while writing).
+inline std::optional<SharedSnapshot> read_snapshot(std::span<const u8> region) {
+    constexpr u32 MAX_ATTEMPTS = 10'000;
+    if (region.size() < sizeof(SharedSnapshot)) {
+        return std::nullopt;
+    }
+    // The mapping is read-only; an atomic load of a lock-free u64 never
+    // writes, so casting away const is safe here.
+    auto* shared = reinterpret_cast<SharedSnapshot*>(const_cast<u8*>(region.data()));
+    std::atomic_ref<u64> sequence(shared->sequence);
+    SharedSnapshot copy;
+    for (u32 attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+        u64 before = sequence.load(std::memory_order_acquire);
+        if (before % 2 == 0) {
+            std::memcpy(&copy, region.data(), sizeof(SharedSnapshot));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                if (copy.magic != SNAPSHOT_MAGIC || copy.version != SNAPSHOT_VERSION) {
+                    return std::nullopt;
+                }
+                copy.sequence = before;
+                return copy;
+            }
+        }
+        std::this_thread::yield();
+    }
+    return std::nullopt;
+}
+
+} // namespace vgce::session
@@ -0,0 +1,101 @@
+#include "session/snapshot_publisher.hpp"
+#include "metrics/trace.hpp"
+#include "process/resource_usage.hpp"
+#include <algorithm>
+
+namespace vgce::session {
+
+namespace {
+
+// Copies text, truncated to leave room for the terminating NUL.
+template <u64 N>
+void copy_text(std::array<char, N>& out, std::string_view text) {
+    out.fill('\0');
+    std::copy_n(text.begin(), std::min<u64>(text.size(), N - 1), out.begin());
+}
+
+// Whole moves only, so a reader never sees half a move.
+void copy_moves(std::array<char, 236>& out, const std::vector<std::string>& moves) {
+    std::string pv;
+    for (const auto& move : moves) {
+        if (pv.size() + move.size() + 1 >= out.size()) {
+            break;
+        }
+        pv += pv.empty() ? move : " " + move;
+    }
+    copy_text(out, pv);
+}
+
+} // namespace
+
+SnapshotPublisher::SnapshotPublisher(const std::string& name, const std::string& engine_name,
+                                     const uci::GlobalStats& stats, const model::SearchTree& tree,
+                                     std::chrono::milliseconds interval)
+        : m_memory(name, sizeof(SharedSnapshot)), m_global_stats(stats), m_tree(tree), m_interval(interval) {
+    // The header is written once, before the first update bumps the sequence.
+    m_snapshot.magic = SNAPSHOT_MAGIC;
+    m_snapshot.version = SNAPSHOT_VERSION;
+    m_snapshot.size = sizeof(SharedSnapshot);
+    m_snapshot.pid = static_cast<u64>(process::current_process_id());
+    copy_text(m_snapshot.engine_name, engine_name);
+    std::memcpy(m_memory.writable_bytes().data(), &m_snapshot, offsetof(SharedSnapshot, sequence));
+    m_thread = std::thread(&SnapshotPublisher::run, this);
+}
+
+SnapshotPublisher::~SnapshotPublisher() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_is_running = false;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void SnapshotPublisher::run() {
+    VGCE_TRACE_THREAD("snapshot");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_is_running) {
+        lock.unlock();
+        publish();
+        lock.lock();
+        m_cv.wait_for(lock, m_interval, [this] { return !m_is_running; });
+    }
+}
+
+void SnapshotPublisher::publish() {
+    VGCE_TRACE_SCOPE("snapshot.publish");
+    m_snapshot.unix_ms = static_cast<u64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    m_snapshot.nodes = m_global_stats.nodes.load(std::memory_order_relaxed);
+    m_snapshot.time_ms = m_global_stats.time_ms.load(std::memory_order_relaxed);
+    m_snapshot.nps = m_global_stats.nps.load(std::memory_order_relaxed);
+    m_snapshot.tbhits = m_global_stats.tbhits.load(std::memory_order_relaxed);
+    m_snapshot.hashfull = m_global_stats.hashfull.load(std::memory_order_relaxed);
+    m_snapshot.depth = m_global_stats.main_depth.load(std::memory_order_relaxed);
+    auto top = m_tree.get_top_line_moves(SNAPSHOT_LINES);
+    copy_text(m_snapshot.root_fen, top.root_position.to_fen());
+
+    const auto& lines = top.lines;
+    m_snapshot.line_count = static_cast<u16>(lines.size());
+    for (u64 i = 0; i < SNAPSHOT_LINES; ++i) {
+        auto& out = m_snapshot.lines[i];
+        out = SnapshotLine{};
+        if (i >= lines.size()) {
+            continue;
+        }
+        const auto& stats = lines[i].stats;
+        out.multipv = lines[i].multipv;
+        out.depth = stats.depth;
+        out.score = stats.score;
+        out.score_type = static_cast<u8>(stats.score_type);
+        out.bound = static_cast<u8>(stats.bound);
+        out.has_wdl = stats.has_wdl ? 1 : 0;
+        out.wdl = stats.wdl;
+        copy_moves(out.pv, top.moves[i]);
+    }
+    write_snapshot(m_memory.writable_bytes(), m_snapshot);
+}
+
+} // namespace vgce::session
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "model/search_tree.hpp"
+#include "process/shared_memory.hpp"
+#include "session/shared_snapshot.hpp"
+#include "uci/uci_data.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace vgce::session {
+
+// Copies GlobalStats and the top lines into a SharedSnapshot at a fixed
+// interval on its own thread, so readers cost the engine pipeline nothing
+// and never see the tree lock.
+class SnapshotPublisher {
+public:
+    static constexpr auto DEFAULT_INTERVAL = std::chrono::milliseconds(50);
+
+    // Throws std::runtime_error if the shared memory cannot be created.
+    SnapshotPublisher(const std::string& name, const std::string& engine_name, const uci::GlobalStats& stats,
+                      const model::SearchTree& tree, std::chrono::milliseconds interval = DEFAULT_INTERVAL);
+    ~SnapshotPublisher();
+
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+private:
+    void run();
+    void publish();
+
+    process::SharedMemory m_memory;
+    const uci::GlobalStats& m_global_stats;
+    const model::SearchTree& m_tree;
+    std::chrono::milliseconds m_interval;
+    SharedSnapshot m_snapshot{};
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_is_running = true;
+    std::thread m_thread;
+};
+
+} // namespace vgce::session
@@ -0,0 +1,85 @@
+#include "chess/position.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct PerftCase {
+    const char* name;
+    const char* fen;
+    std::vector<u64> expected;
+};
+
+// Reference counts from the Chess Programming Wiki perft results.
+const std::vector<PerftCase> CASES = {
+    {"startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+     {20, 400, 8902, 197281, 4865609, 119060324}},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+     {48, 2039, 97862, 4085603, 193690690}},
+    {"position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+     {14, 191, 2812, 43238, 674624, 11030083}},
+    {"position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+     {6, 264, 9467, 422333, 15833292}},
+    {"position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+     {44, 1486, 62379, 2103487, 89941194}},
+};
+
+} // namespace
+
+// Usage: vgce_perft [max-depth] [fen]
+// Without a FEN, runs the reference positions up to max-depth and fails on
+// any mismatch. With a FEN, prints the count for each depth.
+auto main(i32 argc, char* argv[]) -> i32 {
+    using namespace vgce;
+    u16 max_depth = argc > 1 ? static_cast<u16>(std::atoi(argv[1])) : 5;
+
+    std::vector<PerftCase> cases;
+    if (argc > 2) {
+        cases.push_back({"custom", argv[2], {}});
+    } else {
+        cases = CASES;
+    }
+
+    bool passed = true;
+    u64 total_nodes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& test : cases) {
+        chess::Position position;
+        try {
+            position = chess::Position::from_fen(test.fen);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        u16 depth_limit = max_depth;
+        if (!test.expected.empty()) {
+            depth_limit = std::min<u16>(max_depth, static_cast<u16>(test.expected.size()));
+        }
+        for (u16 depth = 1; depth <= depth_limit; ++depth) {
+            auto depth_start = std::chrono::steady_clock::now();
+            u64 nodes = chess::perft(position, depth);
+            auto elapsed = std::chrono::duration<f64>(std::chrono::steady_clock::now() - depth_start);
+            total_nodes += nodes;
+
+            std::cout << test.name << " depth " << depth << ": " << nodes;
+            if (!test.expected.empty()) {
+                bool matches = nodes == test.expected[depth - 1];
+                passed &= matches;
+                std::cout << (matches ? " ok" : " MISMATCH (expected " +
+                                                    std::to_string(test.expected[depth - 1]) + ")");
+            }
+            if (elapsed.count() > 0.0) {
+                std::cout << " (" << static_cast<u64>(static_cast<f64>(nodes) / elapsed.count())
+                          << " nps)";
+            }
+            std::cout << "\n";
+        }
+    }
+
+    auto elapsed = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start);
+    std::cout << "Total: " << total_nodes << " nodes in " << elapsed.count() << "s\n";
+    return passed ? 0 : 1;
+}
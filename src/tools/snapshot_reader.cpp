@@ -0,0 +1,100 @@
+#include "process/shared_memory.hpp"
+#include "session/shared_snapshot.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+
+namespace {
+
+using namespace vgce;
+
+constexpr auto WATCH_INTERVAL = std::chrono::milliseconds(500);
+// The publisher updates every 50 ms, so a sequence this old means it is gone.
+constexpr u32 STALE_POLLS = 6;
+
+std::string format_score(const session::SnapshotLine& line) {
+    std::string text;
+    if (line.score_type == 1) {
+        text = "#" + std::to_string(line.score);
+    } else {
+        text = (line.score >= 0 ? "+" : "-") + std::to_string(std::abs(line.score) / 100) + "." +
+               std::to_string(std::abs(line.score) % 100 / 10) + std::to_string(std::abs(line.score) % 10);
+    }
+    if (line.bound == 1) {
+        text += "+";
+    } else if (line.bound == 2) {
+        text += "-";
+    }
+    return text;
+}
+
+// Fixed-size text fields are NUL-terminated by the publisher, but a reader
+// should not rely on that.
+template <u64 N>
+std::string read_text(const std::array<char, N>& text) {
+    return std::string(text.data(), strnlen(text.data(), N));
+}
+
+void print(const session::SharedSnapshot& snapshot) {
+    std::cout << read_text(snapshot.engine_name) << " (pid " << snapshot.pid << ")\n"
+              << "fen " << read_text(snapshot.root_fen) << "\n"
+              << "depth " << snapshot.depth << " nodes " << snapshot.nodes << " nps " << snapshot.nps
+              << " time " << snapshot.time_ms << "ms hashfull " << snapshot.hashfull << " tbhits "
+              << snapshot.tbhits << "\n";
+    for (u16 i = 0; i < snapshot.line_count && i < session::SNAPSHOT_LINES; ++i) {
+        const auto& line = snapshot.lines[i];
+        std::cout << line.multipv << ". d" << line.depth << " " << format_score(line);
+        if (line.has_wdl) {
+            std::cout << " wdl " << line.wdl[0] << "/" << line.wdl[1] << "/" << line.wdl[2];
+        }
+        std::cout << "  " << read_text(line.pv) << "\n";
+    }
+}
+
+} // namespace
+
+// Usage: vgce_snapshot <name> [--watch]
+// Prints the snapshot a vgce --shm <name> publishes, once or until the
+// publisher goes away.
+auto main(i32 argc, char* argv[]) -> i32 {
+    if (argc < 2) {
+        std::cerr << "Usage: vgce_snapshot <name> [--watch]\n";
+        return 1;
+    }
+    bool watch = argc > 2 && std::string(argv[2]) == "--watch";
+
+    try {
+        process::SharedMemory memory(argv[1]);
+        std::optional<u64> last_sequence;
+        u32 stale_polls = 0;
+        do {
+            auto snapshot = session::read_snapshot(memory.bytes());
+            if (!snapshot) {
+                std::cerr << "No snapshot published under '" << argv[1] << "'\n";
+                return 1;
+            }
+            if (snapshot->sequence != last_sequence) {
+                last_sequence = snapshot->sequence;
+                stale_polls = 0;
+                print(*snapshot);
+                if (watch) {
+                    std::cout << "\n";
+                }
+            } else if (++stale_polls >= STALE_POLLS) {
+                std::cerr << "Publisher stopped\n";
+                return 0;
+            }
+            if (watch) {
+                std::this_thread::sleep_for(WATCH_INTERVAL);
+            }
+        } while (watch);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -1,5 +1,7 @@
 #include "tui/renderer.hpp"
 #include "core/application.hpp"
+#include "metrics/trace.hpp"
+#include "model/move_annotation.hpp"
 #include "ftxui/component/captured_mouse.hpp"
 #include "ftxui/component/component.hpp"
 #include "ftxui/component/component_base.hpp"
@@ -8,8 +10,10 @@
 #include "ftxui/dom/elements.hpp"
 #include "ftxui/dom/node.hpp"
 #include "ftxui/screen/screen.hpp"
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
+#include <utility>
 
 namespace vgce::tui {
 
@@ -17,16 +21,19 @@ using namespace ftxui;
 
 namespace {
 
-constexpr i32 BLUNDER_THRESHOLD_CP = 200;
-constexpr i32 MISTAKE_THRESHOLD_CP = 100;
-constexpr i32 INACCURACY_THRESHOLD_CP = 50;
-constexpr i32 GOOD_THRESHOLD_CP = 30;
-constexpr i32 BRILLIANT_THRESHOLD_CP = 150;
-
 constexpr u64 VISIT_COUNT_THRESHOLD = 10;
 constexpr u64 VISIT_RATIO_DIVISOR = 20;
 constexpr u16 QSEARCH_DEPTH_THRESHOLD = 3;
 
+constexpr u64 RATE_WINDOW_NS = 500'000'000;
+// Queued lines beyond this mean vgce is falling behind the engine.
+constexpr u64 QUEUE_BACKLOG_WARNING = 1000;
+// MultiPV lines listed in the header.
+constexpr u16 HEADER_TOP_LINES = 5;
+// Iterations shown in eval and NPS sparklines.
+constexpr u32 SPARKLINE_POINTS = 16;
+constexpr i64 REPLAY_STEP_NS = 10'000'000'000;
+
 std::string format_large_number(u64 num) {
     if (num >= 1'000'000'000) {
         return std::to_string(num / 1'000'000'000) + "." + 
@@ -41,6 +48,58 @@ std::string format_large_number(u64 num) {
     return std::to_string(num);
 }
 
+std::string format_clock(u64 ns) {
+    u64 seconds = ns / 1'000'000'000;
+    std::string secs = std::to_string(seconds % 60);
+    return std::to_string(seconds / 60) + ":" + (secs.size() < 2 ? "0" : "") + secs;
+}
+
+std::string format_permille(u32 permille) {
+    return std::to_string(permille / 10) + "." + std::to_string(permille % 10) + "%";
+}
+
+std::string core_load_bar(const uci::GlobalStats& stats) {
+    static const char* const LEVELS[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+    u32 cpu_count = std::min(stats.cpu_count.load(), uci::MAX_TRACKED_CPUS);
+    std::string bar;
+    for (u32 cpu = 0; cpu < cpu_count; ++cpu) {
+        u32 load = stats.engine_core_permille[cpu].load(std::memory_order_relaxed);
+        bar += LEVELS[std::min<u32>(load * 8 / 1001, 7)];
+    }
+    return bar;
+}
+
+// One block per value, scaled between the smallest and largest value shown.
+std::string sparkline(const std::vector<i64>& values) {
+    static const char* const LEVELS[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+    if (values.empty()) {
+        return "";
+    }
+    auto [low, high] = std::minmax_element(values.begin(), values.end());
+    i64 range = *high - *low;
+    std::string line;
+    for (i64 value : values) {
+        line += LEVELS[range > 0 ? (value - *low) * 7 / range : 3];
+    }
+    return line;
+}
+
+std::string eval_sparkline(const std::vector<model::ScoreHistory::Point>& points) {
+    std::vector<i64> values;
+    for (const auto& point : points) {
+        values.push_back(point.score);
+    }
+    return sparkline(values);
+}
+
+std::string nps_sparkline(const std::vector<model::ScoreHistory::Point>& points) {
+    std::vector<i64> values;
+    for (const auto& point : points) {
+        values.push_back(point.time_ms > 0 ? static_cast<i64>(point.nodes * 1000 / point.time_ms) : 0);
+    }
+    return sparkline(values);
+}
+
 } // namespace
 
 Renderer::Renderer(model::SearchTree& tree, uci::GlobalStats& stats,
@@ -52,6 +111,7 @@ Renderer::Renderer(model::SearchTree& tree, uci::GlobalStats& stats,
 }
 
 void Renderer::start() {
+    VGCE_TRACE_THREAD("render");
     auto ui = build_ui();
     m_screen.Loop(ui);
 }
@@ -79,6 +139,11 @@ std::string Renderer::format_elapsed_time() const {
 std::string Renderer::format_score(const uci::Score& score) const {
     std::stringstream ss;
     ss << std::fixed << std::setprecision(2);
+    if (score.bound == uci::Score::Bound::Lower) {
+        ss << "≥";
+    } else if (score.bound == uci::Score::Bound::Upper) {
+        ss << "≤";
+    }
     if (score.type == uci::Score::Type::Centipawns) {
         f64 pawns = static_cast<f64>(score.value) / 100.0;
         ss << std::showpos << pawns;
@@ -103,35 +168,11 @@ std::string Renderer::get_move_annotation(const model::SearchTree::Node* node,
         return "";
     }
     
-    i32 node_score = node->get_score_cp();
-    i32 parent_score = parent->get_score_cp();
-    i32 delta = parent_score - node_score;
-    
-    if (std::abs(delta) < INACCURACY_THRESHOLD_CP) {
-        if (delta < -BRILLIANT_THRESHOLD_CP) {
-            return "!!";
-        } else if (delta < -GOOD_THRESHOLD_CP) {
-            return "!";
-        }
-        return "";
-    }
-    
-    if (delta >= BLUNDER_THRESHOLD_CP) {
-        return "??";
-    } else if (delta >= MISTAKE_THRESHOLD_CP) {
-        return "?";
-    } else if (delta >= INACCURACY_THRESHOLD_CP) {
-        return "?!";
-    } else if (delta <= -BRILLIANT_THRESHOLD_CP) {
-        return "!!";
-    } else if (delta <= -GOOD_THRESHOLD_CP) {
-        return "!";
-    }
-    
-    return "";
+    return std::string(model::annotate_move(parent->get_score_cp() - node->get_score_cp()));
 }
 
 Element Renderer::render_header() {
+    VGCE_TRACE_SCOPE("render.header");
     std::string static_eval_str = "N/A";
     if (m_global_stats.static_eval) {
         static_eval_str = format_score(*m_global_stats.static_eval);
@@ -156,6 +197,15 @@ Element Renderer::render_header() {
     if (m_app.is_paused()) {
         engine_text = hbox({engine_text, text(" "), text("[PAUSED]") | color(Color::YellowLight) | bold});
     }
+    if (u16 depth = m_app.converged_depth(); depth > 0) {
+        engine_text = hbox({engine_text, text(" "),
+                            text("[SETTLED d" + std::to_string(depth) + "]") | color(Color::GreenLight) | bold});
+    }
+    if (m_app.position_count() > 1) {
+        engine_text = hbox({engine_text, text(" | Position ") | color(Color::GrayDark),
+                            text(std::to_string(m_app.position_index() + 1) + "/" +
+                                 std::to_string(m_app.position_count())) | bold});
+    }
     
     auto nodes_str = format_large_number(m_global_stats.nodes.load());
     auto nps_str = format_large_number(m_global_stats.nps.load());
@@ -210,20 +260,94 @@ Element Renderer::render_header() {
     
     stats_line3.push_back(text(" | Tree Nodes: ") | color(Color::GrayDark));
     stats_line3.push_back(text(std::to_string(m_search_tree.get_total_nodes())) | bold);
+    if (m_config.merge_transpositions) {
+        stats_line3.push_back(text(" | Merged: ") | color(Color::GrayDark));
+        stats_line3.push_back(text(std::to_string(m_search_tree.get_merged_count())) | bold |
+                              color(Color::MagentaLight));
+    }
 
-    return vbox({
+    auto pipe = m_app.pipe_stats();
+    Elements stats_line4;
+    stats_line4.push_back(text("Pipe: ") | color(Color::GrayDark));
+    stats_line4.push_back(text(format_large_number(pipe.capacity) + "B") | bold);
+    if (pipe.capacity > 0) {
+        stats_line4.push_back(text(" | Peak Fill: ") | color(Color::GrayDark));
+        stats_line4.push_back(text(std::to_string(pipe.peak_fill * 100 / pipe.capacity) + "%") | bold);
+    }
+    stats_line4.push_back(text(" | Engine Stalls: ") | color(Color::GrayDark));
+    std::string stall_str = std::to_string(pipe.full_events);
+    if (pipe.full_events > 0) {
+        stall_str += " (<=" + std::to_string(pipe.stall_bound_total_ns / 1'000'000) + "ms total)";
+    }
+    stats_line4.push_back(text(stall_str) | bold |
+                          color(pipe.full_events > 0 ? Color::RedLight : Color::GreenLight));
+    stats_line4.push_back(text(" | Backlog: ") | color(Color::GrayDark));
+    stats_line4.push_back(text(std::to_string(m_app.queue_stats().depth) + " lines, " +
+                               format_large_number(pipe.spill_bytes) + "B spilled") | bold);
+
+    Elements stats_line5;
+    stats_line5.push_back(text("Engine CPU: ") | color(Color::GrayDark));
+    stats_line5.push_back(text(format_permille(m_global_stats.engine_cpu_permille.load())) | bold);
+    stats_line5.push_back(text(" | RSS: ") | color(Color::GrayDark));
+    stats_line5.push_back(text(format_large_number(m_global_stats.engine_rss_bytes.load()) + "B") | bold);
+    stats_line5.push_back(text(" | Threads: ") | color(Color::GrayDark));
+    stats_line5.push_back(text(std::to_string(m_global_stats.engine_threads.load())) | bold);
+    stats_line5.push_back(text(" | Ctx/s: ") | color(Color::GrayDark));
+    stats_line5.push_back(
+        text(format_large_number(m_global_stats.engine_voluntary_switches_per_sec.load()) +
+             " vol, " +
+             format_large_number(m_global_stats.engine_involuntary_switches_per_sec.load()) +
+             " invol") | bold);
+    stats_line5.push_back(text(" | RunQ: ") | color(Color::GrayDark));
+    stats_line5.push_back(text(format_permille(m_global_stats.engine_run_delay_permille.load())) | bold);
+    stats_line5.push_back(text(" | vgce CPU: ") | color(Color::GrayDark));
+    stats_line5.push_back(text(format_permille(m_global_stats.viewer_cpu_permille.load())) | 
+                          bold | color(Color::Cyan));
+    stats_line5.push_back(text(" RSS: ") | color(Color::GrayDark));
+    stats_line5.push_back(text(format_large_number(m_global_stats.viewer_rss_bytes.load()) + "B") | 
+                          bold | color(Color::Cyan));
+
+    Elements stats_line6;
+    stats_line6.push_back(text("Cores: ") | color(Color::GrayDark));
+    stats_line6.push_back(text(core_load_bar(m_global_stats)) | color(Color::GreenLight));
+
+    Elements rows = {
         hbox({title, text(" | "), engine_text}),
         separator(),
         hbox(stats_line1),
         hbox(stats_line2),
         hbox(stats_line3),
-        separator(),
-    }) | border;
+        hbox(stats_line4),
+        hbox(stats_line5),
+        hbox(stats_line6),
+    };
+    if (m_config.multi_pv > 1) {
+        rows.push_back(separator());
+        for (const auto& line : m_search_tree.get_top_lines(HEADER_TOP_LINES)) {
+            auto score = line.stats.get_score();
+            auto score_elem = text(line.stats.has_score ? format_score(score) : "?") | bold;
+            if (line.stats.has_score && score.type == uci::Score::Type::Centipawns) {
+                score_elem = score_elem | color(get_eval_color(score.value));
+            }
+            rows.push_back(hbox({
+                text("{PV" + std::to_string(line.multipv) + "} ") | color(Color::Cyan),
+                score_elem,
+                text(" d" + std::to_string(line.stats.depth) + " ") | color(Color::GrayDark),
+                text(eval_sparkline(m_search_tree.get_history().last_for_slot(line.multipv, SPARKLINE_POINTS)) +
+                     " ") | color(Color::YellowLight),
+                text(line.moves),
+            }));
+        }
+    }
+    rows.push_back(separator());
+    return vbox(std::move(rows)) | border;
 }
 
-void Renderer::render_tree_node(const model::SearchTree::Node* node, Elements& elements,
+void Renderer::render_tree_node(const model::SearchTree& tree, const model::SearchTree::Edge& edge,
+                                const model::SearchTree::Node* parent, Elements& elements,
                                 const std::string& prefix, bool is_last, u16 current_depth,
                                 u16 ply_number, bool white_to_move) {
+    const auto* node = edge.node.get();
     if (!node || current_depth > m_config.pv_depth_limit) {
         return;
     }
@@ -244,11 +368,13 @@ void Renderer::render_tree_node(const model::SearchTree::Node* node, Elements& e
         move_color = Color::GreenLight;
     } else if (node->multipv_index > 1) {
         move_color = Color::Cyan;
+    } else if (node->is_refined) {
+        move_color = Color::BlueLight;
     }
     
-    line_elements.push_back(text(node->move) | color(move_color) | bold);
+    line_elements.push_back(text(edge.san) | color(move_color) | bold);
     
-    std::string annotation = get_move_annotation(node, node->parent);
+    std::string annotation = get_move_annotation(node, parent);
     if (!annotation.empty()) {
         Color annot_color = Color::Yellow;
         if (annotation == "!!" || annotation == "!") {
@@ -259,31 +385,47 @@ void Renderer::render_tree_node(const model::SearchTree::Node* node, Elements& e
         line_elements.push_back(text(annotation) | color(annot_color) | bold);
     }
 
-    if (node->data.depth) {
+    const auto& stats = node->stats;
+    if (stats.depth) {
         std::stringstream info;
-        info << " (d" << *node->data.depth;
-        if (node->data.seldepth && *node->data.seldepth > *node->data.depth) {
-            info << "/" << *node->data.seldepth;
+        info << " (d" << stats.depth;
+        if (stats.seldepth > stats.depth) {
+            info << "/" << stats.seldepth;
         }
         line_elements.push_back(text(info.str()) | color(Color::GrayDark));
 
-        if (node->data.score) {
+        if (stats.has_score) {
             line_elements.push_back(text(" ") | color(Color::GrayDark));
-            auto score_text = text(format_score(*node->data.score)) | bold;
+            auto score_text = text(format_score(stats.get_score())) | bold;
             score_text = score_text | color(get_eval_color(node->get_score_cp()));
             line_elements.push_back(score_text);
         }
         
         line_elements.push_back(text(")") | color(Color::GrayDark));
         
-        if (node->data.seldepth && node->data.depth && 
-            *node->data.seldepth > *node->data.depth + QSEARCH_DEPTH_THRESHOLD) {
+        if (stats.seldepth > stats.depth + QSEARCH_DEPTH_THRESHOLD) {
             std::stringstream qsearch;
-            qsearch << " [Q+" << (*node->data.seldepth - *node->data.depth) << "]";
+            qsearch << " [Q+" << (stats.seldepth - stats.depth) << "]";
             line_elements.push_back(text(qsearch.str()) | color(Color::Cyan) | dim);
         }
     }
+
+    if (current_depth == 1) {
+        auto history = tree.get_history().last_for_move(edge.san, SPARKLINE_POINTS);
+        if (history.size() > 1) {
+            line_elements.push_back(text(" " + eval_sparkline(history)) | color(Color::YellowLight));
+            line_elements.push_back(text(" " + nps_sparkline(history)) | color(Color::GrayDark));
+        }
+    }
     
+    if (node->is_refined) {
+        line_elements.push_back(text(" ⟳") | color(Color::BlueLight) | bold);
+    }
+
+    if (current_depth == 1 && !node->is_pv_node && edge.san == m_reference_move) {
+        line_elements.push_back(text(" ◂ main best") | color(Color::RedLight) | bold);
+    }
+
     if (node->visit_count > VISIT_COUNT_THRESHOLD) {
         line_elements.push_back(text(" [TT×" + std::to_string(node->visit_count) + "]") | 
                                color(Color::Yellow) | dim);
@@ -294,7 +436,21 @@ void Renderer::render_tree_node(const model::SearchTree::Node* node, Elements& e
                                color(Color::Cyan) | dim);
     }
 
+    // A merged position is expanded under the first line that reaches it.
+    bool is_repeat = node->parent_count > 1 && !m_expanded.insert(node).second;
+    if (node->parent_count > 1) {
+        line_elements.push_back(text(is_repeat ? " ≡ transposes above"
+                                               : " ⇄" + std::to_string(node->parent_count)) |
+                                color(Color::MagentaLight) | dim);
+    }
+
     elements.push_back(hbox(line_elements));
+    i32 line = static_cast<i32>(m_tree_lines.size());
+    m_tree_lines.push_back({m_parent_line, chess::move_to_uci(edge.move)});
+    if (is_repeat) {
+        return;
+    }
+    i32 parent_line = std::exchange(m_parent_line, line);
 
     const std::string child_prefix = prefix + (is_last ? "  " : "│ ");
     const auto& children = node->children;
@@ -303,43 +459,64 @@ void Renderer::render_tree_node(const model::SearchTree::Node* node, Elements& e
     while (it != children.end()) {
         bool is_child_last = (std::next(it) == children.end());
         u16 next_ply = white_to_move ? ply_number : ply_number + 1;
-        render_tree_node(it->second.get(), elements, child_prefix, is_child_last,
+        render_tree_node(tree, *it, node, elements, child_prefix, is_child_last,
                         current_depth + 1, next_ply, !white_to_move);
         ++it;
     }
+    m_parent_line = parent_line;
 }
 
-Element Renderer::render_tree_view() {
+Elements Renderer::render_tree_lines(const model::SearchTree& tree) {
     Elements elements;
-    const auto* root = m_search_tree.get_root();
-    if (!root) {
-        return text("Initializing search...") | center | color(Color::GrayLight);
+    auto root_position = tree.get_root_position();
+    bool white_to_move = root_position.side_to_move() == chess::Color::White;
+    m_expanded.clear();
+    m_parent_line = -1;
+    m_tree_lines.clear();
+    tree.with_root([&](const model::SearchTree::Node& root) {
+        const auto& children = root.children;
+        auto it = children.begin();
+        while (it != children.end()) {
+            bool is_last = (std::next(it) == children.end());
+            render_tree_node(tree, *it, &root, elements, "", is_last, 1,
+                             root_position.fullmove_number(), white_to_move);
+            ++it;
+        }
+    });
+    return elements;
+}
+
+Element Renderer::render_tree_view() {
+    VGCE_TRACE_SCOPE("render.tree_view");
+    if (!m_app.comparisons().empty()) {
+        return render_comparison_view();
     }
-    const auto& children = root->children;
-    if (children.empty()) {
+    m_reference_move.clear();
+    Elements elements = render_tree_lines(m_search_tree);
+    if (elements.empty()) {
         if (m_app.is_paused()) {
             return text("Search is paused. Press Space to resume.") | center | color(Color::YellowLight);
         }
         return text("Waiting for engine output...") | center | color(Color::GrayLight);
     }
 
-    auto it = children.begin();
-    while (it != children.end()) {
-        bool is_last = (std::next(it) == children.end());
-        render_tree_node(it->second.get(), elements, "", is_last, 1, 1, true);
-        ++it;
-    }
-
     const int box_height = 50;
     int total_lines = elements.size();
     
+    m_cursor = std::max(0, std::min(m_cursor, total_lines - 1));
+    if (m_cursor_moved) {
+        m_scroll_position = std::min(m_scroll_position, m_cursor);
+        m_scroll_position = std::max(m_scroll_position, m_cursor - box_height + 1);
+        m_cursor_moved = false;
+    }
     m_scroll_position = std::max(0, std::min(m_scroll_position, total_lines - box_height));
+    m_cursor = std::max(m_scroll_position, std::min(m_cursor, m_scroll_position + box_height - 1));
 
     Elements visible_elements;
     int start = m_scroll_position;
     int end = std::min(total_lines, start + box_height);
     for (int i = start; i < end; ++i) {
-        visible_elements.push_back(elements[i]);
+        visible_elements.push_back(i == m_cursor ? elements[i] | inverted : elements[i]);
     }
 
     Element tree_content = vbox(visible_elements);
@@ -360,6 +537,251 @@ Element Renderer::render_tree_view() {
     });
 }
 
+Element Renderer::render_comparison_view() {
+    struct Column {
+        std::string name;
+        Elements lines;
+    };
+    std::vector<Column> columns;
+    m_reference_move.clear();
+    columns.push_back({m_global_stats.engine_name, render_tree_lines(m_search_tree)});
+    std::string main_best = m_search_tree.get_best_move();
+    for (const auto& session : m_app.comparisons()) {
+        m_reference_move = main_best;
+        columns.push_back({session->stats().engine_name, render_tree_lines(session->tree())});
+    }
+    m_reference_move.clear();
+    // The cursor belongs to the single-tree view.
+    m_tree_lines.clear();
+
+    // One scroll position keeps the columns in step.
+    const int box_height = 50;
+    int total_lines = 0;
+    for (const auto& column : columns) {
+        total_lines = std::max(total_lines, static_cast<int>(column.lines.size()));
+    }
+    m_scroll_position = std::max(0, std::min(m_scroll_position, total_lines - box_height));
+
+    Elements panes;
+    for (auto& column : columns) {
+        Elements visible;
+        int end = std::min(static_cast<int>(column.lines.size()), m_scroll_position + box_height);
+        for (int i = m_scroll_position; i < end; ++i) {
+            visible.push_back(std::move(column.lines[i]));
+        }
+        if (column.lines.empty()) {
+            visible.push_back(text("Waiting for engine output...") | color(Color::GrayLight));
+        }
+        if (!panes.empty()) {
+            panes.push_back(separator());
+        }
+        panes.push_back(vbox({
+            text(" " + column.name) | bold | color(Color::CyanLight),
+            separator(),
+            vbox(std::move(visible)),
+        }) | flex);
+    }
+    return vbox({
+        render_comparison_table(),
+        separator(),
+        hbox(std::move(panes)) | flex,
+    });
+}
+
+// Disagreements are measured against the main engine: a different best move
+// or an eval more than --eval-threshold away. Time-to-depth is compared at the
+// deepest depth every engine has reached.
+Element Renderer::render_comparison_table() {
+    struct Engine {
+        const std::string& name;
+        const uci::GlobalStats& stats;
+        const model::SearchTree& tree;
+    };
+    std::vector<Engine> engines = {{m_global_stats.engine_name, m_global_stats, m_search_tree}};
+    for (const auto& session : m_app.comparisons()) {
+        engines.push_back({session->stats().engine_name, session->stats(), session->tree()});
+    }
+
+    u16 common_depth = uci::MAX_TIMED_DEPTH - 1;
+    for (const auto& engine : engines) {
+        common_depth = std::min(common_depth, engine.stats.main_depth.load());
+    }
+    // The main line, so the eval matches the best move shown beside it.
+    auto best_line = [](const model::SearchTree& tree) { return tree.get_main_line(); };
+    auto main_line = best_line(m_search_tree);
+    std::string main_best = m_search_tree.get_best_move();
+    u32 main_time = common_depth > 0 ? m_global_stats.depth_time_ms[common_depth].load() : 0;
+
+    Elements rows;
+    for (u64 i = 0; i < engines.size(); ++i) {
+        const auto& engine = engines[i];
+        auto line = best_line(engine.tree);
+        std::string best = engine.tree.get_best_move();
+
+        auto best_elem = text(best.empty() ? "..." : best) | bold;
+        if (i > 0 && !best.empty() && !main_best.empty() && best != main_best) {
+            best_elem = best_elem | color(Color::RedLight) | inverted;
+        } else {
+            best_elem = best_elem | color(Color::GreenLight);
+        }
+
+        auto score_elem = text(line && line->stats.has_score ? format_score(line->stats.get_score()) : "?") | bold;
+        if (i > 0 && line && main_line && line->stats.has_score && main_line->stats.has_score &&
+            std::abs(line->stats.get_score().to_cp() - main_line->stats.get_score().to_cp()) >
+                    m_config.eval_threshold) {
+            score_elem = score_elem | color(Color::YellowLight) | inverted;
+        }
+
+        std::string time_to_depth = "-";
+        if (common_depth > 0) {
+            u32 time = engine.stats.depth_time_ms[common_depth].load();
+            time_to_depth = time > 0 ? std::to_string(time) + "ms" : "?";
+            if (i > 0 && time > 0 && main_time > 0) {
+                time_to_depth += " (" + std::to_string(static_cast<u64>(time) * 100 / main_time) + "%)";
+            }
+        }
+
+        rows.push_back(hbox({
+            text(" " + engine.name) | bold | size(WIDTH, EQUAL, 24),
+            text(" d" + std::to_string(engine.stats.main_depth.load())) | size(WIDTH, EQUAL, 6),
+            best_elem | size(WIDTH, EQUAL, 8),
+            score_elem | size(WIDTH, EQUAL, 9),
+            text(" NPS: ") | color(Color::GrayDark),
+            text(format_large_number(engine.stats.nps.load())) | bold | size(WIDTH, EQUAL, 8),
+            text(" t(d" + std::to_string(common_depth) + "): ") | color(Color::GrayDark),
+            text(time_to_depth) | bold,
+        }));
+    }
+    return vbox(std::move(rows));
+}
+
+void Renderer::record_frame_latency() {
+    auto pending = m_search_tree.take_pending_update();
+    if (!pending) {
+        return;
+    }
+    u64 now = metrics::monotonic_ns();
+    auto& latency = m_app.latency();
+    latency.tree_to_frame.record(now - pending->tree_ns);
+    if (pending->read_ns > 0) {
+        latency.read_to_frame.record(now - pending->read_ns);
+    }
+}
+
+Element Renderer::render_latency_overlay() {
+    const auto& latency = m_app.latency();
+    const u64 budget_ns = static_cast<u64>(m_config.latency_budget_ms) * 1'000'000;
+
+    auto cell = [](const std::string& value, int width) {
+        return text(value) | size(WIDTH, EQUAL, width);
+    };
+    auto row = [&](const std::string& stage, const metrics::LatencyHistogram& histogram,
+                   bool enforce_budget) {
+        u64 p99 = histogram.percentile(0.99);
+        Color p99_color = Color::Default;
+        if (enforce_budget && budget_ns > 0) {
+            p99_color = p99 > budget_ns ? Color::RedLight : Color::GreenLight;
+        }
+        return hbox({
+            cell(stage, 14) | color(Color::GrayLight),
+            cell(format_large_number(histogram.count()), 9),
+            cell(metrics::format_duration(histogram.percentile(0.50)), 10),
+            cell(metrics::format_duration(histogram.percentile(0.90)), 10),
+            cell(metrics::format_duration(p99), 10) | bold | color(p99_color),
+            cell(metrics::format_duration(histogram.percentile(0.999)), 10),
+            cell(metrics::format_duration(histogram.max()), 10),
+        });
+    };
+
+    Elements rows;
+    rows.push_back(hbox({
+        cell("Stage", 14), cell("Count", 9), cell("p50", 10), cell("p90", 10),
+        cell("p99", 10), cell("p99.9", 10), cell("max", 10),
+    }) | color(Color::GrayDark));
+    rows.push_back(row("read->parse", latency.read_to_parse, false));
+    rows.push_back(row("parse->tree", latency.parse_to_tree, false));
+    rows.push_back(row("tree->frame", latency.tree_to_frame, false));
+    rows.push_back(row("read->frame", latency.read_to_frame, true));
+    if (latency.gui_to_engine.count() > 0 || latency.engine_to_gui.count() > 0) {
+        rows.push_back(row("gui->engine", latency.gui_to_engine, false));
+        rows.push_back(row("engine->gui", latency.engine_to_gui, false));
+    }
+    if (budget_ns > 0) {
+        rows.push_back(text("Budget: p99 read->frame <= " +
+                            std::to_string(m_config.latency_budget_ms) + "ms") |
+                       color(Color::GrayDark));
+    }
+    return window(text(" Pipeline Latency ") | bold, vbox(rows));
+}
+
+Element Renderer::render_perf_overlay() {
+    auto& counters = m_app.counters();
+    auto queue = m_app.queue_stats();
+
+    RateWindow current;
+    current.sampled_ns = metrics::monotonic_ns();
+    current.lines_in = queue.total_pushed;
+    current.infos_parsed = counters.infos_parsed.load(std::memory_order_relaxed);
+    current.tree_updates = counters.tree_updates.load(std::memory_order_relaxed);
+    current.frames_requested = counters.frames_requested.load(std::memory_order_relaxed);
+    current.frames_rendered = counters.frames_rendered.load(std::memory_order_relaxed);
+
+    // A smaller line count means the engine was swapped for another one.
+    if (m_rate_window.sampled_ns == 0 || current.lines_in < m_rate_window.lines_in) {
+        m_rate_window = current;
+    } else if (u64 elapsed = current.sampled_ns - m_rate_window.sampled_ns;
+               elapsed >= RATE_WINDOW_NS) {
+        auto per_second = [elapsed](u64 now, u64 before) {
+            return (now - before) * 1'000'000'000 / elapsed;
+        };
+        m_rates.lines_in = per_second(current.lines_in, m_rate_window.lines_in);
+        m_rates.infos_parsed = per_second(current.infos_parsed, m_rate_window.infos_parsed);
+        m_rates.tree_updates = per_second(current.tree_updates, m_rate_window.tree_updates);
+        m_rates.frames_requested =
+            per_second(current.frames_requested, m_rate_window.frames_requested);
+        m_rates.frames_rendered = per_second(current.frames_rendered, m_rate_window.frames_rendered);
+        m_rate_window = current;
+    }
+
+    u64 coalesced = m_rates.frames_requested > m_rates.frames_rendered
+                        ? m_rates.frames_requested - m_rates.frames_rendered
+                        : 0;
+    bool is_behind = queue.depth > QUEUE_BACKLOG_WARNING;
+    auto label = [](const std::string& name) { return text(name) | color(Color::GrayDark); };
+
+    Elements rows;
+    rows.push_back(hbox({
+        label("Queue: "),
+        text(std::to_string(queue.depth)) | bold |
+            color(is_behind ? Color::RedLight : Color::GreenLight),
+        label(" (high-water " + format_large_number(queue.high_water) + ")"),
+    }));
+    rows.push_back(hbox({
+        label("Lines in: "), text(format_large_number(m_rates.lines_in) + "/s") | bold,
+        label(" | Parsed: "), text(format_large_number(m_rates.infos_parsed) + "/s") | bold,
+        label(" | Tree updates: "), text(format_large_number(m_rates.tree_updates) + "/s") | bold,
+    }));
+    rows.push_back(hbox({
+        label("Frames: "), text(format_large_number(m_rates.frames_rendered) + "/s") | bold,
+        label(" rendered, "), text(format_large_number(coalesced) + "/s") | bold,
+        label(" coalesced | Frame time: "),
+        text(metrics::format_duration(counters.last_frame_ns.load(std::memory_order_relaxed))) | bold,
+        label(" last, "),
+        text(metrics::format_duration(counters.frame_time.percentile(0.99))) | bold,
+        label(" p99"),
+    }));
+    rows.push_back(hbox({
+        label("Tree: "), text(format_large_number(m_search_tree.get_total_nodes())) | bold,
+        label(" nodes, "), text(format_large_number(m_search_tree.get_memory_bytes()) + "B") | bold,
+        label(m_config.tree_memory_mb > 0
+                  ? " of " + std::to_string(m_config.tree_memory_mb) + "MB, " +
+                        format_large_number(m_search_tree.get_evicted_count()) + " branches evicted"
+                  : ""),
+    }));
+    rows.push_back(is_behind ? text("vgce is behind the engine") | color(Color::RedLight)
+                             : text("vgce is keeping up") | color(Color::GreenLight));
+    return window(text(" Viewer Performance ") | bold, vbox(rows));
+}
 
 Element Renderer::render_footer() {
     Elements help_elements;
@@ -372,8 +794,37 @@ Element Renderer::render_footer() {
     help_elements.push_back(text(" Clear ") | color(Color::GrayDark));
     help_elements.push_back(text("e") | color(Color::GreenLight));
     help_elements.push_back(text(" Export ") | color(Color::GrayDark));
+    help_elements.push_back(text("r") | color(Color::BlueLight));
+    u16 refining = m_app.refinements_running();
+    help_elements.push_back(text(refining > 0 ? " Refining " + std::to_string(refining) + " " : " Refine ") |
+                            color(refining > 0 ? Color::BlueLight : Color::GrayDark));
+    if (m_app.position_count() > 1) {
+        help_elements.push_back(text("n") | color(Color::BlueLight));
+        help_elements.push_back(text(" Next ") | color(Color::GrayDark));
+    }
+    if (m_app.is_replaying()) {
+        help_elements.push_back(text("[ ]") | color(Color::BlueLight));
+        help_elements.push_back(text(" Depth ") | color(Color::GrayDark));
+        help_elements.push_back(text(", .") | color(Color::BlueLight));
+        help_elements.push_back(text(" ±10s ") | color(Color::GrayDark));
+    }
+    help_elements.push_back(text("l") | color(Color::CyanLight));
+    help_elements.push_back(text(" Latency ") | color(Color::GrayDark));
+    help_elements.push_back(text("p") | color(Color::CyanLight));
+    help_elements.push_back(text(" Perf ") | color(Color::GrayDark));
+    if (metrics::trace::enabled()) {
+        help_elements.push_back(text("t") | color(Color::YellowLight));
+        help_elements.push_back(text(" Trace ") | color(Color::GrayDark));
+    }
     help_elements.push_back(text("q") | color(Color::RedLight));
     help_elements.push_back(text(" Quit") | color(Color::GrayDark));
+    if (m_app.is_replaying()) {
+        help_elements.push_back(filler());
+        help_elements.push_back(text("Replay " + format_clock(m_app.replay_cursor_ns()) + " / " +
+                                     format_clock(m_app.replay_duration_ns()) + " d" +
+                                     std::to_string(m_app.replay_depth()) + " ") | bold |
+                                color(Color::BlueLight));
+    }
     
     return hbox(help_elements) | border;
 }
@@ -383,7 +834,20 @@ Component Renderer::build_ui() {
     auto footer = ftxui::Renderer([this] { return render_footer(); });
 
     auto tree_view_component = ftxui::Renderer([this] {
-        return render_tree_view() | flex;
+        auto tree_view = render_tree_view() | flex;
+        record_frame_latency();
+        Elements overlays;
+        if (m_show_perf) {
+            overlays.push_back(render_perf_overlay());
+        }
+        if (m_show_latency) {
+            overlays.push_back(render_latency_overlay());
+        }
+        if (overlays.empty()) {
+            return tree_view;
+        }
+        overlays.push_back(tree_view);
+        return vbox(overlays) | flex;
     });
 
     // Explicitly create the vector of components to fix the initialization error.
@@ -393,8 +857,20 @@ Component Renderer::build_ui() {
     children.push_back(footer);
     
     auto main_container = Container::Vertical(children);
+
+    // Times everything vgce does to build a frame.
+    auto timed_container = ftxui::Renderer(main_container, [this, main_container] {
+        u64 start = metrics::monotonic_ns();
+        auto frame = main_container->Render();
+        u64 frame_ns = metrics::monotonic_ns() - start;
+        auto& counters = m_app.counters();
+        counters.frame_time.record(frame_ns);
+        counters.last_frame_ns.store(frame_ns, std::memory_order_relaxed);
+        metrics::bump(counters.frames_rendered);
+        return frame;
+    });
     
-    auto final_component = CatchEvent(main_container, [this](Event event) {
+    auto final_component = CatchEvent(timed_container, [this](Event event) {
         if (event.is_mouse()) {
             if (event.mouse().button == Mouse::WheelUp) {
                 m_scroll_position--;
@@ -406,11 +882,24 @@ Component Renderer::build_ui() {
             }
         }
         if (event == Event::ArrowUp) {
-            m_scroll_position--;
+            m_cursor--;
+            m_cursor_moved = true;
             return true;
         }
         if (event == Event::ArrowDown) {
-            m_scroll_position++;
+            m_cursor++;
+            m_cursor_moved = true;
+            return true;
+        }
+        if (event == Event::Character('r')) {
+            if (m_cursor >= 0 && m_cursor < static_cast<int>(m_tree_lines.size())) {
+                std::vector<std::string> path;
+                for (i32 line = m_cursor; line >= 0; line = m_tree_lines[line].parent) {
+                    path.push_back(m_tree_lines[line].move);
+                }
+                std::reverse(path.begin(), path.end());
+                m_app.refine_node(path);
+            }
             return true;
         }
         if (event == Event::PageUp) {
@@ -446,6 +935,41 @@ Component Renderer::build_ui() {
             m_app.export_tree();
             return true;
         }
+        if (event == Event::Character('n')) {
+            m_app.next_position();
+            return true;
+        }
+        if (event == Event::Character('l')) {
+            m_show_latency = !m_show_latency;
+            return true;
+        }
+        if (event == Event::Character('p')) {
+            m_show_perf = !m_show_perf;
+            return true;
+        }
+        if (event == Event::Character('t')) {
+            m_app.dump_trace();
+            return true;
+        }
+        if (m_app.is_replaying()) {
+            using Kind = core::ReplayTarget::Kind;
+            if (event == Event::Character('[')) {
+                m_app.seek_replay({Kind::DepthDelta, -1});
+                return true;
+            }
+            if (event == Event::Character(']')) {
+                m_app.seek_replay({Kind::DepthDelta, 1});
+                return true;
+            }
+            if (event == Event::Character(',')) {
+                m_app.seek_replay({Kind::TimeDelta, -REPLAY_STEP_NS});
+                return true;
+            }
+            if (event == Event::Character('.')) {
+                m_app.seek_replay({Kind::TimeDelta, REPLAY_STEP_NS});
+                return true;
+            }
+        }
         
         return false;
     });
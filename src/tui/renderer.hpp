@@ -7,6 +7,7 @@
 #include <atomic>
 #include <chrono>
 #include <mutex>
+#include <unordered_set>
 
 namespace vgce::core {
 struct AppConfig;
@@ -28,9 +29,16 @@ private:
     ftxui::Component build_ui();
     ftxui::Element render_header();
     ftxui::Element render_tree_view();
+    ftxui::Elements render_tree_lines(const model::SearchTree& tree);
+    ftxui::Element render_comparison_view();
+    ftxui::Element render_comparison_table();
     ftxui::Element render_footer();
+    ftxui::Element render_latency_overlay();
+    ftxui::Element render_perf_overlay();
+    void record_frame_latency();
     
-    void render_tree_node(const model::SearchTree::Node* node, ftxui::Elements& elements,
+    void render_tree_node(const model::SearchTree& tree, const model::SearchTree::Edge& edge,
+                          const model::SearchTree::Node* parent, ftxui::Elements& elements,
                           const std::string& prefix, bool is_last, u16 current_depth,
                           u16 ply_number, bool white_to_move);
     
@@ -47,7 +55,38 @@ private:
     std::chrono::steady_clock::time_point& m_search_start_time;
     vgce::core::Application& m_app;
 
+    // Counter snapshot for the performance overlay; rates are per second.
+    struct RateWindow {
+        u64 sampled_ns = 0;
+        u64 lines_in = 0;
+        u64 infos_parsed = 0;
+        u64 tree_updates = 0;
+        u64 frames_requested = 0;
+        u64 frames_rendered = 0;
+    };
+
     int m_scroll_position = 0;
+    // Tree line under the cursor; the view follows it after cursor keys.
+    int m_cursor = 0;
+    bool m_cursor_moved = false;
+    bool m_show_latency = false;
+    bool m_show_perf = false;
+    RateWindow m_rate_window;
+    RateWindow m_rates;
+    // Merged positions already expanded in the frame being built.
+    std::unordered_set<const model::SearchTree::Node*> m_expanded;
+    // In a comparison column, the main engine's best move where it differs.
+    std::string m_reference_move;
+    // Each line of the single-tree view as its parent node's line (-1 for a
+    // root move) and the UCI move from there, so a frame adds one move per
+    // line; the cursor's full path is only built when refinement asks.
+    struct TreeLine {
+        i32 parent;
+        std::string move;
+    };
+    std::vector<TreeLine> m_tree_lines;
+    // Line of the node whose children are being rendered.
+    i32 m_parent_line = -1;
 };
 
 } // namespace vgce::tui
@@ -0,0 +1,213 @@
+#include "uci/engine_pool.hpp"
+#include "uci/event_loop.hpp"
+#include <algorithm>
+
+namespace vgce::uci {
+
+namespace {
+
+constexpr std::chrono::milliseconds HANDSHAKE_TIMEOUT{10000};
+// Generous because large Hash settings are allocated before readyok.
+constexpr std::chrono::milliseconds READY_TIMEOUT{60000};
+
+// The setup commands are pipelined behind uciok and confirmed by one readyok.
+Task<bool> configure(UciClient& client, const std::vector<std::string>& setup_commands) {
+    if (!co_await client.uci(HANDSHAKE_TIMEOUT)) {
+        co_return false;
+    }
+    for (const auto& command : setup_commands) {
+        client.send_command(command);
+    }
+    co_return (co_await client.isready(READY_TIMEOUT)).has_value();
+}
+
+Task<bool> reset(UciClient& client) {
+    client.send_command("stop");
+    client.send_command("ucinewgame");
+    co_return (co_await client.isready(READY_TIMEOUT)).has_value();
+}
+
+} // namespace
+
+EnginePool::EnginePool(EngineConfig config, u16 spare_count)
+    : m_config(std::move(config)), m_spare_count(spare_count) {
+    m_worker = std::thread(&EnginePool::worker_loop, this);
+}
+
+EnginePool::~EnginePool() {
+    shutdown();
+}
+
+void EnginePool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_is_running) {
+            return;
+        }
+        m_is_running = false;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& client : m_idle) {
+        client->stop();
+    }
+    for (auto& client : m_returned) {
+        client->stop();
+    }
+    m_idle.clear();
+    m_returned.clear();
+}
+
+std::unique_ptr<UciClient> EnginePool::acquire(std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_idle.empty()) {
+        if (!m_is_running || m_launch_failed) {
+            return nullptr;
+        }
+        if (m_pending == 0) {
+            lock.unlock();
+            // A launch that throws fails the pool just as one that returns
+            // nothing, so callers retrying until has_failed() stop.
+            std::unique_ptr<UciClient> client;
+            try {
+                client = launch();
+            } catch (const std::exception&) {
+                std::lock_guard<std::mutex> failed_lock(m_mutex);
+                m_launch_failed = true;
+                throw;
+            }
+            if (!client) {
+                std::lock_guard<std::mutex> failed_lock(m_mutex);
+                m_launch_failed = true;
+            }
+            return client;
+        }
+        if (m_cv.wait_until(lock, deadline) == std::cv_status::timeout && m_idle.empty()) {
+            return nullptr;
+        }
+    }
+
+    auto client = std::move(m_idle.front());
+    m_idle.pop_front();
+    lock.unlock();
+    m_cv.notify_all();
+    return client;
+}
+
+void EnginePool::release(std::unique_ptr<UciClient> client) {
+    if (!client) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_is_running) {
+            m_returned.push_back(std::move(client));
+            ++m_pending;
+        }
+    }
+    if (client) {
+        client->stop();
+    }
+    m_cv.notify_all();
+}
+
+u16 EnginePool::idle_count() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<u16>(m_idle.size());
+}
+
+bool EnginePool::has_failed() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_launch_failed;
+}
+
+std::unique_ptr<UciClient> EnginePool::launch() {
+    auto process = std::make_unique<process::Process>(m_config.executable, m_config.args,
+                                                      m_config.placement, m_config.pipe_size);
+    auto client = std::make_unique<UciClient>(std::move(process));
+    client->start(m_config.reader_placement);
+
+    EventLoop loop;
+    loop.watch(*client);
+    if (!loop.run(configure(*client, m_config.setup_commands))) {
+        client->stop();
+        return nullptr;
+    }
+    return client;
+}
+
+bool EnginePool::recycle(UciClient& client) {
+    EventLoop loop;
+    loop.watch(client);
+    if (!loop.run(reset(client))) {
+        return false;
+    }
+    loop.unwatch(client);
+    client.get_output_queue().clear();
+    return client.is_running();
+}
+
+void EnginePool::worker_loop() {
+    while (true) {
+        std::unique_ptr<UciClient> returned;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] {
+                return !m_is_running || !m_returned.empty() ||
+                       (!m_launch_failed && m_idle.size() + m_pending < m_spare_count);
+            });
+            if (!m_is_running) {
+                return;
+            }
+            if (!m_returned.empty()) {
+                returned = std::move(m_returned.front());
+                m_returned.pop_front();
+            } else {
+                ++m_pending;
+            }
+        }
+
+        std::unique_ptr<UciClient> client;
+        if (returned) {
+            if (recycle(*returned)) {
+                client = std::move(returned);
+            }
+        } else {
+            try {
+                client = launch();
+            } catch (const std::exception&) {
+                client = nullptr;
+            }
+            if (!client) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_launch_failed = true;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_pending;
+            // Recycled engines are kept even without spares so that the next
+            // acquire() reuses them instead of starting cold.
+            u64 capacity = std::max<u64>(m_spare_count, 1);
+            if (client && m_is_running && m_idle.size() < capacity) {
+                m_idle.push_back(std::move(client));
+            }
+        }
+        m_cv.notify_all();
+
+        if (client) {
+            client->stop();
+        }
+        if (returned) {
+            returned->stop();
+        }
+    }
+}
+
+} // namespace vgce::uci
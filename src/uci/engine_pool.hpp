@@ -0,0 +1,67 @@
+#pragma once
+
+#include "process/placement.hpp"
+#include "uci/uci_client.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vgce::uci {
+
+struct EngineConfig {
+    std::filesystem::path executable;
+    std::vector<std::string> args;
+    process::Placement placement;
+    process::Placement reader_placement;
+    u64 pipe_size = process::DEFAULT_PIPE_SIZE;
+    // Sent after uciok and confirmed with isready, e.g. "setoption name Hash value 4096".
+    std::vector<std::string> setup_commands;
+};
+
+// Keeps a number of spare engines launched, handshaken and configured in the
+// background so that acquiring one costs nothing on the critical path.
+// Released engines are reset with ucinewgame and kept for reuse. With no
+// spares, acquire() launches synchronously when nothing is on the way.
+class EnginePool {
+public:
+    EnginePool(EngineConfig config, u16 spare_count);
+    ~EnginePool();
+
+    EnginePool(const EnginePool&) = delete;
+    EnginePool& operator=(const EnginePool&) = delete;
+
+    // Returns nullptr on timeout or if the engine fails its handshake. Throws
+    // if the engine executable cannot be launched.
+    std::unique_ptr<UciClient> acquire(std::chrono::milliseconds timeout);
+    void release(std::unique_ptr<UciClient> client);
+
+    u16 idle_count() const;
+    bool has_failed() const;
+    void shutdown();
+
+private:
+    void worker_loop();
+    std::unique_ptr<UciClient> launch();
+    bool recycle(UciClient& client);
+
+    EngineConfig m_config;
+    u16 m_spare_count;
+    // Engines being launched or recycled that will end up idle.
+    u16 m_pending = 0;
+
+    std::deque<std::unique_ptr<UciClient>> m_idle;
+    std::deque<std::unique_ptr<UciClient>> m_returned;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_is_running = true;
+    bool m_launch_failed = false;
+    std::thread m_worker;
+};
+
+} // namespace vgce::uci
@@ -0,0 +1,112 @@
+#include "uci/event_loop.hpp"
+#include "metrics/trace.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace vgce::uci {
+
+namespace {
+
+// A pass that found nothing waits this long on one of the queues.
+constexpr auto IDLE_WAIT = std::chrono::milliseconds(1);
+
+Task<std::optional<process::Line>> await_request(UciClient::Request request) {
+    co_return co_await request;
+}
+
+} // namespace
+
+// Requests are dropped before the tasks, so no client is left pointing into
+// a destroyed coroutine.
+EventLoop::~EventLoop() {
+    while (!m_watches.empty()) {
+        unwatch(*m_watches.back()->client);
+    }
+    m_spawned.clear();
+}
+
+void EventLoop::watch(UciClient& client, LineHandler on_line) {
+    if (client.m_loop) {
+        throw std::runtime_error("UCI client is already watched by an EventLoop");
+    }
+    client.m_loop = this;
+    m_watches.push_back(std::make_shared<Watch>(Watch{&client, std::move(on_line)}));
+}
+
+void EventLoop::unwatch(UciClient& client) {
+    auto it = std::find_if(m_watches.begin(), m_watches.end(),
+                           [&client](const auto& watch) { return watch->client == &client; });
+    if (it == m_watches.end()) {
+        return;
+    }
+    client.m_pending.reset();
+    client.m_loop = nullptr;
+    (*it)->client = nullptr;
+    m_watches.erase(it);
+}
+
+void EventLoop::spawn(Task<void> task) {
+    task.start();
+    m_spawned.push_back(std::move(task));
+}
+
+std::optional<process::Line> EventLoop::run(UciClient::Request request) {
+    return run(await_request(std::move(request)));
+}
+
+void EventLoop::poll() {
+    VGCE_TRACE_SCOPE("loop.poll");
+    bool was_busy = false;
+    // Indexed, and each watch held by a copy, because resumed coroutines may
+    // watch and unwatch clients.
+    for (u64 i = 0; i < m_watches.size(); ++i) {
+        auto watch = m_watches[i];
+        while (watch->client) {
+            auto line = watch->client->get_output_queue().pop();
+            if (!line) {
+                break;
+            }
+            was_busy = true;
+            if (!deliver(watch, *line)) {
+                break;
+            }
+        }
+        if (watch->client) {
+            if (auto handle = watch->client->expire(std::chrono::steady_clock::now())) {
+                was_busy = true;
+                handle.resume();
+            }
+        }
+    }
+
+    for (auto& task : m_spawned) {
+        if (task.is_done()) {
+            task.take();
+        }
+    }
+    std::erase_if(m_spawned, [](const Task<void>& task) { return task.is_done(); });
+
+    if (was_busy) {
+        return;
+    }
+    if (m_watches.empty()) {
+        std::this_thread::sleep_for(IDLE_WAIT);
+        return;
+    }
+    auto watch = m_watches[m_next_wait++ % m_watches.size()];
+    if (auto line = watch->client->get_output_queue().wait_and_pop(IDLE_WAIT)) {
+        deliver(watch, *line);
+    }
+}
+
+bool EventLoop::deliver(const std::shared_ptr<Watch>& watch, process::Line& line) {
+    if (auto handle = watch->client->resolve(line)) {
+        handle.resume();
+    } else if (watch->on_line) {
+        watch->on_line(line);
+    }
+    return watch->client != nullptr;
+}
+
+} // namespace vgce::uci
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "uci/task.hpp"
+#include "uci/uci_client.hpp"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace vgce::uci {
+
+// Runs coroutines that drive UCI engines, all on the calling thread: each
+// pass takes the lines the watched clients' reader threads have queued,
+// resolves the requests waiting on them and expires the ones past their
+// deadline. Any number of engines share the one thread.
+class EventLoop {
+public:
+    // Lines that answer no request, such as info lines.
+    using LineHandler = std::function<void(const process::Line&)>;
+
+    EventLoop() = default;
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // While watched, the client's output queue belongs to the loop.
+    void watch(UciClient& client, LineHandler on_line = {});
+    // Drops a waiting request without resuming it.
+    void unwatch(UciClient& client);
+
+    // Runs the task alongside any others until it is done, then returns its
+    // result or rethrows its exception.
+    template <typename T>
+    T run(Task<T> task) {
+        task.start();
+        while (!task.is_done()) {
+            poll();
+        }
+        return task.take();
+    }
+    std::optional<process::Line> run(UciClient::Request request);
+    // Starts a task that later passes keep running.
+    void spawn(Task<void> task);
+    // One pass, waiting briefly if there was nothing to do; for threads that
+    // interleave the loop with work of their own. Rethrows the exception a
+    // spawned task ended with.
+    void poll();
+
+private:
+    // Shared so a watch survives being dropped by the handler or coroutine
+    // it is running.
+    struct Watch {
+        UciClient* client;
+        LineHandler on_line;
+    };
+
+    // Returns false once the watch has been dropped.
+    bool deliver(const std::shared_ptr<Watch>& watch, process::Line& line);
+
+    std::vector<std::shared_ptr<Watch>> m_watches;
+    std::vector<Task<void>> m_spawned;
+    u64 m_next_wait = 0;
+};
+
+} // namespace vgce::uci
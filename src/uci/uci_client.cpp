@@ -1,5 +1,9 @@
 #include "uci/uci_client.hpp"
+#include "metrics/trace.hpp"
+#include <algorithm>
 #include <chrono>
+#include <stdexcept>
+#include <utility>
 
 namespace vgce::uci {
 
@@ -13,7 +17,8 @@ UciClient::~UciClient() {
     }
 }
 
-void UciClient::start() {
+void UciClient::start(const process::Placement& reader_placement) {
+    m_reader_placement = reader_placement;
     m_is_running.store(true);
     m_reader_thread = std::thread(&UciClient::reader_loop, this);
 }
@@ -30,19 +35,113 @@ void UciClient::send_command(std::string_view command) {
     m_process->write_line(command);
 }
 
-ConcurrentQueue<std::string>& UciClient::get_output_queue() {
+UciClient::Request UciClient::uci(std::chrono::milliseconds timeout) {
+    return Request(*this, "uci", "uciok", timeout);
+}
+
+UciClient::Request UciClient::isready(std::chrono::milliseconds timeout) {
+    return Request(*this, "isready", "readyok", timeout);
+}
+
+UciClient::Request UciClient::go(std::string_view limits, std::chrono::milliseconds timeout) {
+    std::string command = limits.empty() ? "go" : "go " + std::string(limits);
+    return Request(*this, std::move(command), "bestmove", timeout);
+}
+
+UciClient::Request UciClient::expect(std::string_view reply, std::chrono::milliseconds timeout) {
+    return Request(*this, {}, reply, timeout);
+}
+
+void UciClient::halt(std::chrono::milliseconds timeout) {
+    send_command("stop");
+    if (m_pending && m_pending->reply == "bestmove") {
+        m_pending->deadline = std::min(m_pending->deadline, std::chrono::steady_clock::now() + timeout);
+    }
+}
+
+void UciClient::Request::await_suspend(std::coroutine_handle<> handle) {
+    if (!m_client.m_loop) {
+        throw std::runtime_error("UCI request on a client no EventLoop is watching");
+    }
+    if (m_client.m_pending) {
+        throw std::runtime_error("UCI request while another is still waiting");
+    }
+    auto deadline = m_timeout == NO_TIMEOUT ? std::chrono::steady_clock::time_point::max()
+                                            : std::chrono::steady_clock::now() + m_timeout;
+    m_client.m_pending = PendingRequest{m_reply, deadline, handle, &m_response};
+    if (!m_command.empty()) {
+        m_client.send_command(m_command);
+    }
+}
+
+std::coroutine_handle<> UciClient::resolve(process::Line& line) {
+    constexpr std::string_view ID_NAME_PREFIX = "id name ";
+
+    if (line.text.starts_with(ID_NAME_PREFIX)) {
+        m_engine_name = line.text.substr(ID_NAME_PREFIX.size());
+    }
+    if (!m_pending || !line.text.starts_with(m_pending->reply)) {
+        return {};
+    }
+    *m_pending->response = std::move(line);
+    return std::exchange(m_pending, std::nullopt)->handle;
+}
+
+// An engine that exited is given until its last lines are consumed.
+std::coroutine_handle<> UciClient::expire(std::chrono::steady_clock::time_point now) {
+    if (!m_pending) {
+        return {};
+    }
+    bool is_gone = !m_is_running.load() && m_output_queue->empty();
+    if (now < m_pending->deadline && !is_gone) {
+        return {};
+    }
+    return std::exchange(m_pending, std::nullopt)->handle;
+}
+
+bool UciClient::is_running() const {
+    return m_is_running.load();
+}
+
+i64 UciClient::pid() const {
+    return m_process->pid();
+}
+
+void UciClient::mirror_output(i32 fd, metrics::LatencyHistogram* forward_latency) {
+    m_process->mirror_output(fd, forward_latency);
+}
+
+i64 UciClient::forward_input(i32 fd, std::string& copy, metrics::LatencyHistogram* forward_latency) {
+    return m_process->forward_input(fd, copy, forward_latency);
+}
+
+const std::string& UciClient::engine_name() const {
+    return m_engine_name;
+}
+
+ConcurrentQueue<process::Line>& UciClient::get_output_queue() {
+    return *m_output_queue;
+}
+
+std::shared_ptr<const ConcurrentQueue<process::Line>> UciClient::share_output_queue() const {
     return m_output_queue;
 }
 
+std::shared_ptr<const process::PipeCounters> UciClient::share_pipe_counters() const {
+    return m_process->share_pipe_counters();
+}
+
 void UciClient::reader_loop() {
+    if (!m_reader_placement.empty()) {
+        process::apply_to_current_thread(m_reader_placement);
+    }
+    VGCE_TRACE_THREAD("reader");
+
     while (m_is_running.load()) {
         if (auto line = m_process->read_line()) {
-            m_output_queue.push(std::move(*line));
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        }
-
-        if (!m_process->is_running()) {
+            VGCE_TRACE_SCOPE("queue.push");
+            m_output_queue->push(std::move(*line));
+        } else if (!m_process->is_running()) {
             m_is_running.store(false);
         }
     }
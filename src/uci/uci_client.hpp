@@ -4,34 +4,111 @@
 #include "process/process.hpp"
 #include "types.hpp"
 #include <atomic>
+#include <chrono>
+#include <coroutine>
 #include <memory>
+#include <optional>
 #include <string>
 #include <thread>
 
 namespace vgce::uci {
 
+class EventLoop;
+
 class UciClient {
 public:
+    // co_await resolves to the response line, or nothing on timeout or if
+    // the engine exits first. The client must be watched by an EventLoop,
+    // and only one request can be waiting at a time; commands sent without
+    // waiting, such as setoption, pipeline ahead of it.
+    class Request {
+    public:
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        std::optional<process::Line> await_resume() { return std::move(m_response); }
+
+    private:
+        friend class UciClient;
+
+        Request(UciClient& client, std::string command, std::string_view reply,
+                std::chrono::milliseconds timeout)
+                : m_client(client), m_command(std::move(command)), m_reply(reply), m_timeout(timeout) {}
+
+        UciClient& m_client;
+        std::string m_command;
+        std::string_view m_reply;
+        std::chrono::milliseconds m_timeout;
+        std::optional<process::Line> m_response;
+    };
+
     explicit UciClient(std::unique_ptr<process::Process> engine_process);
     ~UciClient();
 
     UciClient(const UciClient&) = delete;
     UciClient& operator=(const UciClient&) = delete;
 
-    void start();
+    void start(const process::Placement& reader_placement = {});
     void stop();
 
     void send_command(std::string_view command);
 
-    ConcurrentQueue<std::string>& get_output_queue();
+    // Waits for as long as the engine runs.
+    static constexpr std::chrono::milliseconds NO_TIMEOUT = std::chrono::milliseconds::max();
+
+    // Awaitable commands. uci() also picks up the engine name. A go that
+    // times out is left running; halt() ends it.
+    Request uci(std::chrono::milliseconds timeout);
+    Request isready(std::chrono::milliseconds timeout);
+    Request go(std::string_view limits, std::chrono::milliseconds timeout);
+    // Awaits a reply to commands already sent, such as the bestmove of a
+    // search started with send_command(). reply must outlive the request.
+    Request expect(std::string_view reply, std::chrono::milliseconds timeout);
+    // Sends stop. A go() still waiting is given at most timeout more for its
+    // bestmove. Called on the watching loop's thread.
+    void halt(std::chrono::milliseconds timeout);
+
+    bool is_running() const;
+    i64 pid() const;
+    const std::string& engine_name() const;
+
+    // Passthrough for running as another program's engine; see
+    // process::Process::mirror_output and forward_input.
+    void mirror_output(i32 fd, metrics::LatencyHistogram* forward_latency);
+    i64 forward_input(i32 fd, std::string& copy, metrics::LatencyHistogram* forward_latency);
+
+    ConcurrentQueue<process::Line>& get_output_queue();
+    // For readers of the queue's counters that must not outlive it, such as
+    // a stats scrape racing an engine hand-over.
+    std::shared_ptr<const ConcurrentQueue<process::Line>> share_output_queue() const;
+    // Likewise for the engine's stdout pipe counters.
+    std::shared_ptr<const process::PipeCounters> share_pipe_counters() const;
 
 private:
+    friend class EventLoop;
+
+    struct PendingRequest {
+        std::string_view reply;
+        std::chrono::steady_clock::time_point deadline;
+        std::coroutine_handle<> handle;
+        std::optional<process::Line>* response = nullptr;
+    };
+
     void reader_loop();
+    // Called by the watching EventLoop. Each returns the coroutine to resume,
+    // or a null handle if none is due.
+    std::coroutine_handle<> resolve(process::Line& line);
+    std::coroutine_handle<> expire(std::chrono::steady_clock::time_point now);
 
     std::unique_ptr<process::Process> m_process;
     std::thread m_reader_thread;
-    ConcurrentQueue<std::string> m_output_queue;
+    std::shared_ptr<ConcurrentQueue<process::Line>> m_output_queue =
+            std::make_shared<ConcurrentQueue<process::Line>>();
     std::atomic<bool> m_is_running{false};
+    process::Placement m_reader_placement;
+    std::string m_engine_name;
+    // Loop thread only.
+    EventLoop* m_loop = nullptr;
+    std::optional<PendingRequest> m_pending;
 };
 
 } // namespace vgce::uci
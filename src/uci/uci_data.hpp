@@ -1,6 +1,7 @@
 #pragma once
 
 #include "types.hpp"
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <optional>
@@ -10,9 +11,23 @@
 namespace vgce::uci {
 
 struct Score {
-    enum class Type { Centipawns, Mate };
+    enum class Type : u8 { Centipawns, Mate };
+    // Lower and upper bounds come from aspiration window fail-highs and lows.
+    enum class Bound : u8 { Exact, Lower, Upper };
+    // Mates count as this many centipawns so they can be compared with
+    // ordinary scores.
+    static constexpr i32 MATE_CP = 10000;
+
     Type type;
     i32 value;
+    Bound bound = Bound::Exact;
+
+    i32 to_cp() const {
+        if (type == Type::Centipawns) {
+            return value;
+        }
+        return value > 0 ? MATE_CP : -MATE_CP;
+    }
 };
 
 struct WDL {
@@ -21,6 +36,9 @@ struct WDL {
     u32 loss;
 };
 
+constexpr u32 MAX_TRACKED_CPUS = 256;
+constexpr u16 MAX_TIMED_DEPTH = 128;
+
 struct GlobalStats {
     std::atomic<u64> nodes{0};
     std::atomic<u32> nps{0};
@@ -33,6 +51,28 @@ struct GlobalStats {
     u16 current_multipv{1};
     std::string current_move;
     u16 current_move_number{0};
+
+    // Sampled from the OS. CPU figures are per mille of one core, so a fully
+    // busy 8-thread engine reads 8000.
+    std::atomic<u32> engine_cpu_permille{0};
+    std::atomic<u64> engine_rss_bytes{0};
+    std::atomic<u32> engine_threads{0};
+    std::atomic<u32> engine_voluntary_switches_per_sec{0};
+    std::atomic<u32> engine_involuntary_switches_per_sec{0};
+    std::atomic<u32> engine_run_delay_permille{0};
+    std::atomic<u32> viewer_cpu_permille{0};
+    std::atomic<u64> viewer_rss_bytes{0};
+    std::atomic<u32> cpu_count{0};
+    std::array<std::atomic<u16>, MAX_TRACKED_CPUS> engine_core_permille{};
+
+    // Main-line depth and the engine time in ms at which each depth was
+    // first reached, 0 if the engine did not say.
+    std::atomic<u16> main_depth{0};
+    std::array<std::atomic<u32>, MAX_TIMED_DEPTH> depth_time_ms{};
+    // The main line's latest score, for readers that must not take the tree
+    // lock. Mates read as +-10000 cp, with the signed distance in main_mate.
+    std::atomic<i32> main_score_cp{0};
+    std::atomic<i32> main_mate{0};
 };
 
 struct InfoData {
@@ -52,6 +92,10 @@ struct InfoData {
     std::string raw_string;
     std::string currmove;
     std::optional<u16> currmovenumber;
+
+    // metrics::monotonic_ns() stamps for latency accounting.
+    u64 read_ns = 0;
+    u64 parse_ns = 0;
 };
 
 } // namespace vgce::uci
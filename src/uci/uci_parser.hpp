@@ -1,5 +1,6 @@
 #pragma once
 
+#include "metrics/trace.hpp"
 #include "uci_data.hpp"
 #include "types.hpp"
 #include <charconv>
@@ -38,6 +39,7 @@ std::optional<f64> parse_float(std::string_view sv);
 } // namespace detail
 
 inline std::optional<InfoData> parse_line(std::string_view line) {
+    VGCE_TRACE_SCOPE("uci.parse_line");
     if (line.starts_with("info string")) {
         return detail::parse_info_string(line);
     }
@@ -63,6 +65,15 @@ inline std::optional<InfoData> parse_info_search(std::string_view line) {
         } else if (token == "score" && i + 2 < tokens.size()) {
             data.score = parse_score(tokens[i + 1], tokens[i + 2]);
             i += 2;
+            if (data.score && i + 1 < tokens.size()) {
+                if (tokens[i + 1] == "lowerbound") {
+                    data.score->bound = Score::Bound::Lower;
+                    ++i;
+                } else if (tokens[i + 1] == "upperbound") {
+                    data.score->bound = Score::Bound::Upper;
+                    ++i;
+                }
+            }
         } else if (token == "nodes" && i + 1 < tokens.size()) {
             data.nodes = parse_unsigned<u64>(tokens[++i]);
         } else if (token == "nps" && i + 1 < tokens.size()) {